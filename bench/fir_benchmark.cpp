@@ -0,0 +1,201 @@
+/**
+ * @file
+ *
+ * Compares the stage 2 Parks-McClellan low-pass filter run
+ * by digital_filter, from runtime coefficients, and by
+ * fixed_fir, specialized for them at compile time, with
+ * each instruction set the CPU supports. Also compares
+ * transforming the X and Y velocities together with
+ * transform_channels() to two calls to transform(), as do
+ * stage 2 and the decimation stage.
+ *
+ * The timings are only meaningful from an optimized build,
+ * e.g. one configured with CMAKE_BUILD_TYPE=Release.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "digital_filter.h"
+#include "fir_kernels.h"
+#include "fixed_fir.h"
+#include "pm_lpf_coeffs.h"
+#include "polyphase_filter.h"
+
+/**
+ * The number of samples filtered per measurement, about
+ * 11 minutes of telemetry at 30 Hz.
+ */
+static const size_t SIGNAL_LEN = 20000;
+
+/**
+ * The number of times each measurement is repeated, of
+ * which the fastest is reported.
+ */
+static const int REPEATS = 9;
+
+/**
+ * Measures the fastest of several runs of a function.
+ *
+ * @tparam F the type of the function
+ * @param f the function to measure
+ * @return the fastest run time, ms
+ */
+template<typename F>
+static double best_time(F f) {
+    double best = INFINITY;
+    for (int r = 0; r < REPEATS; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+
+    return best;
+}
+
+/**
+ * Measures the fastest of several runs of each of two
+ * functions, alternating between them so that both see the
+ * same conditions.
+ *
+ * @tparam F the type of the first function
+ * @tparam G the type of the second function
+ * @param f the first function
+ * @param g the second function
+ * @param f_ms set to the fastest run time of f, ms
+ * @param g_ms set to the fastest run time of g, ms
+ */
+template<typename F, typename G>
+static void best_times(F f, G g, double &f_ms, double &g_ms) {
+    f_ms = INFINITY;
+    g_ms = INFINITY;
+    for (int r = 0; r < REPEATS; ++r) {
+        f_ms = std::min(f_ms, best_time(f));
+        g_ms = std::min(g_ms, best_time(g));
+    }
+}
+
+/**
+ * Measures transforming two channels with two calls to
+ * transform() and with one call to transform_channels().
+ *
+ * @tparam Filter the type of the filter
+ * @param filter the filter, with its instruction set
+ * selected
+ * @param x the first channel
+ * @param y the second channel
+ * @param separate_ms set to the fastest run time of the
+ * separate transforms, ms
+ * @param channels_ms set to the fastest run time of the
+ * transform of both channels, ms
+ */
+template<typename Filter>
+static void measure_channels(const Filter &filter,
+                             const std::vector<double> &x,
+                             const std::vector<double> &y,
+                             double &separate_ms,
+                             double &channels_ms) {
+    best_times([&]() {
+        std::vector<double> x_out = filter.transform(x);
+        std::vector<double> y_out = filter.transform(y);
+    }, [&]() {
+        std::vector<std::vector<double>> out = filter.transform_channels({x, y});
+    }, separate_ms, channels_ms);
+}
+
+/**
+ * Measures filtering the signal as one block and sample by
+ * sample.
+ *
+ * @param filter the filter, with its instruction set
+ * selected
+ * @param signal the signal to filter
+ * @param block_ms set to the fastest block run time, ms
+ * @param sample_ms set to the fastest per-sample run time,
+ * ms
+ */
+static void measure(signal_filter &filter, const std::vector<double> &signal, double &block_ms, double &sample_ms) {
+    std::vector<double> out(signal.size());
+    block_ms = best_time([&]() {
+        filter.reset();
+        filter.process_block(signal, out);
+    });
+    sample_ms = best_time([&]() {
+        filter.reset();
+        for (size_t i = 0; i < signal.size(); ++i) {
+            out[i] = filter.process(signal[i]);
+        }
+    });
+}
+
+int main() {
+    // Telemetry velocities are slowly varying, with noise
+    std::mt19937 rng{1};
+    std::normal_distribution<double> noise{0, 5};
+    std::vector<double> signal(SIGNAL_LEN);
+    std::vector<double> signal_y(SIGNAL_LEN);
+    for (size_t i = 0; i < SIGNAL_LEN; ++i) {
+        signal[i] = 2000 * std::sin(i / 3000.0) + noise(rng);
+        signal_y[i] = 1500 * std::cos(i / 2000.0) + noise(rng);
+    }
+
+    std::printf("%zu samples, %zu taps, best of %d, ms\n\n", SIGNAL_LEN, PM_LPF_COEFFS.size(), REPEATS);
+    std::printf("%-8s  %15s %10s  %15s %10s\n", "ISA", "digital block", "fixed", "digital sample", "fixed");
+
+    for (simd_isa isa : {simd_isa::scalar, simd_isa::sse2, simd_isa::avx2, simd_isa::avx512}) {
+        if (!fir_kernels::supported(isa)) {
+            continue;
+        }
+
+        digital_filter runtime_lpf{{PM_LPF_COEFFS.begin(), PM_LPF_COEFFS.end()}};
+        runtime_lpf.set_isa(isa);
+        fixed_fir<PM_LPF_COEFFS> fixed_lpf;
+        fixed_lpf.set_isa(isa);
+
+        double runtime_block, runtime_sample, fixed_block, fixed_sample;
+        measure(runtime_lpf, signal, runtime_block, runtime_sample);
+        measure(fixed_lpf, signal, fixed_block, fixed_sample);
+
+        std::printf("%-8s  %15.3f %10.3f  %15.3f %10.3f\n",
+                    fir_kernels::name(isa), runtime_block, fixed_block, runtime_sample, fixed_sample);
+    }
+
+    std::printf("\nX and Y velocities, two transforms and transform_channels, ms\n\n");
+    std::printf("%-8s  %10s %10s  %10s %10s\n", "ISA", "digital", "channels", "fixed", "channels");
+
+    for (simd_isa isa : {simd_isa::scalar, simd_isa::sse2, simd_isa::avx2, simd_isa::avx512}) {
+        if (!fir_kernels::supported(isa)) {
+            continue;
+        }
+
+        digital_filter runtime_lpf{{PM_LPF_COEFFS.begin(), PM_LPF_COEFFS.end()}};
+        runtime_lpf.set_isa(isa);
+        fixed_fir<PM_LPF_COEFFS> fixed_lpf;
+        fixed_lpf.set_isa(isa);
+
+        double runtime_separate, runtime_channels, fixed_separate, fixed_channels;
+        measure_channels(runtime_lpf, signal, signal_y, runtime_separate, runtime_channels);
+        measure_channels(fixed_lpf, signal, signal_y, fixed_separate, fixed_channels);
+
+        std::printf("%-8s  %10.3f %10.3f  %10.3f %10.3f\n",
+                    fir_kernels::name(isa), runtime_separate, runtime_channels, fixed_separate, fixed_channels);
+    }
+
+    // The decimator as configured by --decimate 3
+    polyphase_decimator decimator{polyphase_decimator::design_lowpass(3, 4), 3};
+    double decimator_separate, decimator_channels;
+    measure_channels(decimator, signal, signal_y, decimator_separate, decimator_channels);
+    std::printf("\nDecimation by 3 (%s), two transforms %.3f, transform_channels %.3f\n",
+                fir_kernels::name(fir_kernels::detect()), decimator_separate, decimator_channels);
+
+    std::printf("\nStage 2 uses %s on this CPU (%s)\n",
+                fir_kernels::detect() == simd_isa::avx512 ? "fixed_fir" : "digital_filter",
+                fir_kernels::name(fir_kernels::detect()));
+
+    return 0;
+}
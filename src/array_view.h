@@ -0,0 +1,196 @@
+/**
+ * @file
+ */
+
+#ifndef TELEM_FILTER_ARRAY_VIEW_H
+#define TELEM_FILTER_ARRAY_VIEW_H
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Represents a non-owning view of a contiguous array
+ * of elements.
+ *
+ * The viewed memory must outlive the view. This serves the
+ * same purpose as the C++20 std::span.
+ *
+ * @tparam T the element type, which is const-qualified for
+ * read-only views
+ */
+template<typename T>
+class array_view {
+private:
+    /**
+     * The pointer to the first element.
+     */
+    T *ptr{nullptr};
+    /**
+     * The number of elements in the view.
+     */
+    size_t len{0};
+
+public:
+    /**
+     * Creates an empty view.
+     */
+    array_view() = default;
+
+    /**
+     * Creates a view of the given elements.
+     *
+     * @param ptr the pointer to the first element
+     * @param len the number of elements
+     */
+    array_view(T *ptr, size_t len);
+
+    /**
+     * Creates a view of the contents of a vector.
+     *
+     * @tparam U the vector element type
+     * @param vec the vector whose elements are viewed
+     */
+    template<typename U, typename = std::enable_if_t<std::is_same_v<const U, const T>>>
+    array_view(std::vector<U> &vec);
+
+    /**
+     * Creates a read-only view of the contents of a vector.
+     *
+     * @tparam U the vector element type
+     * @param vec the vector whose elements are viewed
+     */
+    template<typename U, typename = std::enable_if_t<std::is_same_v<const U, T>>>
+    array_view(const std::vector<U> &vec);
+
+    /**
+     * Creates a read-only view from a mutable view.
+     *
+     * @tparam U the mutable element type
+     * @param view the view to convert
+     */
+    template<typename U, typename = std::enable_if_t<std::is_same_v<const U, T> &&
+                                                     !std::is_same_v<U, T>>>
+    array_view(const array_view<U> &view);
+
+    /**
+     * Obtains the pointer to the first element.
+     *
+     * @return the element pointer
+     */
+    [[nodiscard]] T *data() const;
+
+    /**
+     * Obtains the number of elements in the view.
+     *
+     * @return the view length
+     */
+    [[nodiscard]] size_t size() const;
+
+    /**
+     * Determines whether the view has no elements.
+     *
+     * @return true if the view is empty
+     */
+    [[nodiscard]] bool empty() const;
+
+    /**
+     * Obtains the element at the given index, which must be
+     * less than size().
+     *
+     * @param idx the element index
+     * @return the reference to the element
+     */
+    T &operator[](size_t idx) const;
+
+    /**
+     * Obtains the iterator to the first element.
+     *
+     * @return the begin iterator
+     */
+    [[nodiscard]] T *begin() const;
+
+    /**
+     * Obtains the iterator past the last element.
+     *
+     * @return the end iterator
+     */
+    [[nodiscard]] T *end() const;
+
+    /**
+     * Obtains a view of a range of elements of this view.
+     *
+     * @param offset the index of the first element
+     * @param count the number of elements, which is clamped
+     * to the end of this view
+     * @return the sub-view
+     */
+    [[nodiscard]] array_view<T> subview(size_t offset, size_t count) const;
+};
+
+template<typename T>
+array_view<T>::array_view(T *ptr, size_t len) :
+        ptr(ptr), len(len) {
+}
+
+template<typename T>
+template<typename U, typename>
+array_view<T>::array_view(std::vector<U> &vec) :
+        array_view(vec.data(), vec.size()) {
+}
+
+template<typename T>
+template<typename U, typename>
+array_view<T>::array_view(const std::vector<U> &vec) :
+        array_view(vec.data(), vec.size()) {
+}
+
+template<typename T>
+template<typename U, typename>
+array_view<T>::array_view(const array_view<U> &view) :
+        array_view(view.data(), view.size()) {
+}
+
+template<typename T>
+T *array_view<T>::data() const {
+    return ptr;
+}
+
+template<typename T>
+size_t array_view<T>::size() const {
+    return len;
+}
+
+template<typename T>
+bool array_view<T>::empty() const {
+    return len == 0;
+}
+
+template<typename T>
+T &array_view<T>::operator[](size_t idx) const {
+    return ptr[idx];
+}
+
+template<typename T>
+T *array_view<T>::begin() const {
+    return ptr;
+}
+
+template<typename T>
+T *array_view<T>::end() const {
+    return ptr + len;
+}
+
+template<typename T>
+array_view<T> array_view<T>::subview(size_t offset, size_t count) const {
+    if (offset > len) {
+        offset = len;
+    }
+    if (count > len - offset) {
+        count = len - offset;
+    }
+
+    return {ptr + offset, count};
+}
+
+#endif // TELEM_FILTER_ARRAY_VIEW_H
@@ -0,0 +1,88 @@
+#include "decimation_plotter.h"
+
+#include <stdexcept>
+
+decimation_plotter::decimation_plotter(stage_2_plotter &prior_stage, unsigned int factor) :
+        staged_telem_plotter<stage_2_plotter>(prior_stage),
+        factor(factor) {
+    if (factor == 0) {
+        throw std::invalid_argument{"Decimation factor must be nonzero."};
+    }
+}
+
+const telem_data &decimation_plotter::get_processed_data() const {
+    return processed_data;
+}
+
+void decimation_plotter::plotter_draw(mglGraph *gr) {
+    std::scoped_lock<std::mutex> lock{data_mutex};
+
+    gr->Clf();
+
+    gr->SubPlot(2, 1, 0);
+    gr->Title("Time vs. v_x");
+    gr->Label('x', "Time (s)");
+    gr->Label('y', "Velocity (m/s)");
+    gr->Grid();
+    gr->Box();
+    gr->SetRanges(data.SubData(0), data.SubData(1));
+    gr->Axis("xy");
+    gr->Plot(data.SubData(0), data.SubData(1), "r-");
+
+    gr->SubPlot(2, 1, 1);
+    gr->Title("Time vs. v_y");
+    gr->Label('x', "Time (s)");
+    gr->Label('y', "Velocity (m/s)");
+    gr->Grid();
+    gr->Box();
+    gr->SetRanges(data.SubData(0), data.SubData(2));
+    gr->Axis("xy");
+    gr->Plot(data.SubData(0), data.SubData(2), "r-");
+}
+
+void decimation_plotter::plotter_calc() {
+    data.Create(3, 1);
+
+    prior_stage.join();
+    velocity_series_view v_stage_2 = prior_stage.get_result();
+    const telem_data &stage_2_data = prior_stage.get_processed_data();
+
+    decimation_result decimated = process_decimation(v_stage_2, stage_2_data, factor);
+    processed_data = std::move(decimated.processed_data);
+    result = std::move(decimated.velocities);
+
+    array_view<const double> result_times = result.view().get_times();
+    for (size_t i = 0; i < result.size(); ++i) {
+        emit({result_times[i], result.get(i)});
+    }
+
+    // Plotting
+    array_view<const double> decimated_times = processed_data.get_times();
+
+    int time_steps = result.size();
+    for (int i = 0; i < time_steps; ++i) {
+        double t = decimated_times[i];
+        vector2d v_decimated = result.get(i);
+
+        // Record data to the matrix
+        {
+            std::scoped_lock<std::mutex> lock{data_mutex};
+
+            // Expand the data matrix for new data
+            if (i != 0) {
+                data.Insert('y', i);
+            }
+
+            // 0: Time
+            data.Put(t, 0, i);
+
+            // 1: Velocity X
+            data.Put(v_decimated.get_x(), 1, i);
+            // 2: Velocity Y
+            data.Put(v_decimated.get_y(), 2, i);
+        }
+
+        Check();
+        plotter_update();
+    }
+}
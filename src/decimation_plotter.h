@@ -0,0 +1,60 @@
+/**
+ * @file
+ */
+
+#ifndef TELEM_FILTER_DECIMATION_PLOTTER_H
+#define TELEM_FILTER_DECIMATION_PLOTTER_H
+
+#include "stage_2_plotter.h"
+
+/**
+ * @brief Optional stage of telemetry processing and
+ * plotting between stages 2 and 3.
+ *
+ * The velocities from stage 2 are band-limited far below
+ * the telemetry sample rate, so this stage reduces them to
+ * a lower rate using a polyphase decimator. The processed
+ * telemetry data is decimated by the same factor, so later
+ * stages process proportionally fewer samples.
+ */
+class decimation_plotter : public staged_telem_plotter<stage_2_plotter> {
+private:
+    /**
+     * The downsampling factor.
+     */
+    unsigned int factor;
+
+    /**
+     * The processed telemetry data from stage 2, reduced to
+     * every factor-th sample.
+     */
+    telem_data processed_data;
+
+public:
+    /**
+     * Creates a new decimation processor/plotter using the
+     * data from stage 2.
+     *
+     * @param prior_stage the stage 2 data
+     * @param factor the downsampling factor
+     * @throws std::invalid_argument if the factor is zero
+     */
+    decimation_plotter(stage_2_plotter &prior_stage, unsigned int factor);
+
+    /**
+     * Obtains the processed telemetry data from stage 2,
+     * decimated to match the result of this stage.
+     *
+     * Not valid until join() returns or the first velocity
+     * is popped from the stream of this stage.
+     *
+     * @return the processed telemetry data
+     */
+    [[nodiscard]] const telem_data &get_processed_data() const;
+
+    void plotter_draw(mglGraph *gr) override;
+
+    void plotter_calc() override;
+};
+
+#endif // TELEM_FILTER_DECIMATION_PLOTTER_H
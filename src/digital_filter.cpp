@@ -1,45 +1,380 @@
 #include "digital_filter.h"
 
-#include <deque>
+#include <algorithm>
+#include <stdexcept>
+
+/**
+ * The shortest block which is worth convolving with the
+ * block kernel rather than sample by sample.
+ */
+static const size_t MIN_CONV_BLOCK = 16;
+
+/**
+ * The ratio of the FFT size to the number of taps, which
+ * trades transform cost against the fraction of each
+ * segment discarded as overlap.
+ */
+static const size_t FFT_SIZE_RATIO = 4;
+
+/**
+ * Determines the number of taps from which FFT overlap-save
+ * is faster than filtering directly with an instruction
+ * set.
+ *
+ * Each crossover was measured with linear-phase
+ * coefficients, which all of the filter designs have. The
+ * scalar one is against filtering sample by sample, which
+ * the scalar instruction set does instead of convolving
+ * blocks.
+ *
+ * @param isa the instruction set
+ * @return the smallest number of taps for overlap-save
+ */
+static size_t fft_min_taps(simd_isa isa) {
+    switch (isa) {
+        case simd_isa::scalar:
+            return 32;
+        case simd_isa::sse2:
+            return 160;
+        case simd_isa::avx2:
+            return 320;
+        case simd_isa::avx512:
+        default:
+            return 384;
+    }
+}
+
+/**
+ * Overwrites the second half of the coefficients with the
+ * mirror image of the first half.
+ *
+ * @param b the numerator coefficients
+ * @param symmetry the symmetry to impose
+ * @return the mirrored coefficients
+ */
+static std::vector<double> mirror_coeffs(std::vector<double> b, fir_symmetry symmetry) {
+    if (symmetry == fir_symmetry::none) {
+        return b;
+    }
+
+    size_t taps = b.size();
+    double sign = symmetry == fir_symmetry::antisymmetric ? -1 : 1;
+    for (size_t k = 0; k < taps / 2; ++k) {
+        b[taps - 1 - k] = sign * b[k];
+    }
+    if (symmetry == fir_symmetry::antisymmetric && taps % 2 != 0) {
+        b[taps / 2] = 0;
+    }
+
+    return b;
+}
 
 digital_filter::digital_filter(std::vector<double> b,
                                std::vector<double> a) :
-        b(std::move(b)), a(std::move(a)) {
+        b(std::move(b)), a(std::move(a)),
+        x_hist(2 * this->b.size(), 0),
+        y_hist(2 * this->a.size(), 0),
+        b_rev(this->b.rbegin(), this->b.rend()) {
+    // The input and output histories are sized by the
+    // coefficients, so each needs at least one
+    if (this->b.empty() || this->a.empty()) {
+        throw std::invalid_argument{"Filter requires numerator and denominator coefficients."};
+    }
+
+    use_fft();
+    use_symmetry(detect_symmetry(this->b));
 }
 
 digital_filter::digital_filter(std::vector<double> b) :
         digital_filter::digital_filter(std::move(b), {1}) {
 }
 
-std::vector<double> digital_filter::transform(const std::vector<double> &signal) {
-    std::vector<double> result;
-    result.reserve(signal.size());
+digital_filter::digital_filter(std::vector<double> b, fir_symmetry symmetry) :
+        digital_filter::digital_filter(mirror_coeffs(std::move(b), symmetry), {1}) {
+    use_symmetry(symmetry);
+}
+
+fir_symmetry digital_filter::detect_symmetry(const std::vector<double> &b) {
+    size_t taps = b.size();
+    if (taps < 2) {
+        return fir_symmetry::none;
+    }
 
-    std::deque<double> x_buf;
-    x_buf.resize(b.size(), 0);
-    std::deque<double> y_buf;
-    y_buf.resize(a.size(), 0);
+    bool symmetric = true;
+    bool antisymmetric = taps % 2 == 0 || b[taps / 2] == 0;
+    for (size_t k = 0; k < taps / 2; ++k) {
+        symmetric = symmetric && b[k] == b[taps - 1 - k];
+        antisymmetric = antisymmetric && b[k] == -b[taps - 1 - k];
+    }
+
+    if (symmetric) {
+        return fir_symmetry::symmetric;
+    }
+    return antisymmetric ? fir_symmetry::antisymmetric : fir_symmetry::none;
+}
+
+void digital_filter::use_symmetry(fir_symmetry symmetry) {
+    this->symmetry = symmetry;
+    if (symmetry == fir_symmetry::none) {
+        b_half.clear();
+        b_rev_half.clear();
+        sym_dot = nullptr;
+        sym_conv = nullptr;
+        sym_conv_channels = nullptr;
+        return;
+    }
 
-    for (double x : signal) {
-        x_buf.push_front(x);
-        x_buf.resize(x_buf.size() - 1);
+    size_t half_len = (b.size() + 1) / 2;
+    b_half.assign(b.begin(), b.begin() + half_len);
+    b_rev_half.assign(b_rev.begin(), b_rev.begin() + half_len);
 
-        double x_sigma = 0;
-        for (int i = 0; i < x_buf.size(); ++i) {
-            x_sigma += b[i] * x_buf[i];
+    bool antisymmetric = symmetry == fir_symmetry::antisymmetric;
+    sym_dot = fir_kernels::sym_dot(isa, antisymmetric);
+    sym_conv = fir_kernels::sym_conv(isa, antisymmetric);
+    sym_conv_channels = fir_kernels::sym_conv_channels(isa, antisymmetric);
+}
+
+void digital_filter::use_fft() {
+    if (a.size() != 1 || b.size() < fft_min_taps(isa)) {
+        fft_plan = nullptr;
+        b_spectrum.clear();
+        return;
+    }
+    if (fft_plan != nullptr) {
+        return;
+    }
+
+    fft_plan = std::make_shared<const fft>(fft::next_size(FFT_SIZE_RATIO * b.size()));
+
+    b_spectrum.assign(fft_plan->size(), 0);
+    std::copy(b.begin(), b.end(), b_spectrum.begin());
+    fft_plan->forward(b_spectrum.data());
+}
+
+std::vector<double> digital_filter::transform(array_view<const double> signal) const {
+    std::vector<double> result(signal.size());
+
+    digital_filter stream{*this};
+    stream.reset();
+    stream.process_block(signal, result);
+
+    return result;
+}
+
+std::vector<std::vector<double>> digital_filter::transform_channels(
+        const std::vector<array_view<const double>> &signals) const {
+    size_t len = channel_length(signals);
+    size_t taps = b.size();
+    size_t hist_len = taps - 1;
+    bool fft_block = fft_plan != nullptr && len >= fft_plan->size();
+    if (a.size() != 1 || isa == simd_isa::scalar || fft_block || len < hist_len + MIN_CONV_BLOCK) {
+        return signal_filter::transform_channels(signals);
+    }
+
+    size_t channels = signals.size();
+    std::vector<std::vector<double>> results(channels, std::vector<double>(len));
+    std::vector<const double *> samples(channels);
+    std::vector<double *> out(channels);
+    auto convolve = [&](size_t n) {
+        if (symmetry != fir_symmetry::none) {
+            sym_conv_channels(b_rev_half.data(), taps, samples.data(), out.data(), channels, n);
+        } else {
+            conv_channels(b_rev.data(), taps, samples.data(), out.data(), channels, n);
         }
+    };
+
+    // The first taps - 1 outputs reach back before the
+    // start, so they are convolved from zero-padded copies
+    // of it
+    std::vector<double> head(2 * hist_len * channels, 0);
+    for (size_t c = 0; c < channels; ++c) {
+        double *padded = head.data() + 2 * hist_len * c;
+        std::copy(signals[c].begin(), signals[c].begin() + hist_len, padded + hist_len);
+        samples[c] = padded;
+        out[c] = results[c].data();
+    }
+    convolve(hist_len);
 
-        double y_sigma = 0;
-        for (int i = 1; i < y_buf.size(); ++i) {
-            y_sigma += a[i] * y_buf[i];
+    // The remaining outputs are convolved from the channels
+    // in place
+    for (size_t c = 0; c < channels; ++c) {
+        samples[c] = signals[c].data();
+        out[c] = results[c].data() + hist_len;
+    }
+    convolve(len - hist_len);
+
+    if (a[0] != 1) {
+        for (std::vector<double> &result : results) {
+            for (double &y : result) {
+                y /= a[0];
+            }
         }
+    }
 
-        double y = (x_sigma - y_sigma) / a[0];
-        y_buf.push_front(y);
-        y_buf.resize(y_buf.size() - 1);
+    return results;
+}
 
-        result.push_back(y);
+std::vector<double> digital_filter::filtfilt(array_view<const double> signal) const {
+    size_t len = signal.size();
+    if (len == 0) {
+        return {};
     }
 
-    return result;
+    // Extend both ends by odd reflection about the end
+    // samples
+    size_t nfilt = std::max(b.size(), a.size());
+    size_t pad = std::min(3 * (nfilt - 1), len - 1);
+    std::vector<double> ext(len + 2 * pad);
+    for (size_t i = 0; i < pad; ++i) {
+        ext[i] = 2 * signal[0] - signal[pad - i];
+        ext[pad + len + i] = 2 * signal[len - 1] - signal[len - 2 - i];
+    }
+    std::copy(signal.begin(), signal.end(), ext.begin() + pad);
+
+    digital_filter stream{*this};
+    stream.reset_steady(ext.front());
+    stream.process_block(ext, ext);
+
+    std::reverse(ext.begin(), ext.end());
+    stream.reset_steady(ext.front());
+    stream.process_block(ext, ext);
+    std::reverse(ext.begin(), ext.end());
+
+    return {ext.begin() + pad, ext.begin() + pad + len};
+}
+
+void digital_filter::push_input(double x) {
+    size_t x_len = b.size();
+    x_pos = (x_pos == 0 ? x_len : x_pos) - 1;
+    x_hist[x_pos] = x;
+    x_hist[x_pos + x_len] = x;
+}
+
+double digital_filter::process(double x) {
+    push_input(x);
+
+    size_t x_len = b.size();
+    double x_sigma = symmetry != fir_symmetry::none
+                     ? sym_dot(b_half.data(), x_hist.data() + x_pos, x_len)
+                     : dot(b.data(), x_hist.data() + x_pos, x_len);
+
+    // y_hist[y_pos + i - 1] is the output from i samples ago
+    size_t y_len = a.size();
+    double y_sigma = y_len > 1 ? dot(a.data() + 1, y_hist.data() + y_pos, y_len - 1) : 0;
+
+    double y = (x_sigma - y_sigma) / a[0];
+    y_pos = (y_pos == 0 ? y_len : y_pos) - 1;
+    y_hist[y_pos] = y;
+    y_hist[y_pos + y_len] = y;
+
+    return y;
+}
+
+void digital_filter::process_block(array_view<const double> in, array_view<double> out) {
+    size_t len = in.size();
+    bool fft_block = fft_plan != nullptr && len >= fft_plan->size();
+    if (a.size() != 1 || (isa == simd_isa::scalar && !fft_block) || len < MIN_CONV_BLOCK) {
+        for (size_t i = 0; i < len; ++i) {
+            out[i] = process(in[i]);
+        }
+
+        return;
+    }
+
+    // Lay out the last taps - 1 inputs, oldest first,
+    // followed by the block itself
+    size_t taps = b.size();
+    size_t hist_len = taps - 1;
+    block_buf.resize(hist_len + len);
+    for (size_t k = 0; k < hist_len; ++k) {
+        block_buf[k] = x_hist[x_pos + hist_len - 1 - k];
+    }
+    std::copy(in.begin(), in.end(), block_buf.begin() + hist_len);
+
+    if (fft_block) {
+        convolve_fft(block_buf.data(), out.data(), len);
+    } else if (symmetry != fir_symmetry::none) {
+        sym_conv(b_rev_half.data(), taps, block_buf.data(), out.data(), len);
+    } else {
+        conv(b_rev.data(), taps, block_buf.data(), out.data(), len);
+    }
+    if (a[0] != 1) {
+        for (size_t i = 0; i < len; ++i) {
+            out[i] /= a[0];
+        }
+    }
+
+    // Only the newest inputs remain in the history
+    for (size_t i = len - std::min(len, taps); i < len; ++i) {
+        push_input(block_buf[hist_len + i]);
+    }
+}
+
+void digital_filter::convolve_fft(const double *samples, double *out, size_t n) {
+    size_t fft_size = fft_plan->size();
+    size_t overlap = b.size() - 1;
+    size_t seg_len = fft_size - overlap;
+    size_t samples_len = n + overlap;
+    fft_buf.resize(fft_size);
+
+    for (size_t start = 0; start < n; start += 2 * seg_len) {
+        // Pack this segment and the next as real and
+        // imaginary parts, zero padding past the input
+        for (size_t i = 0; i < fft_size; ++i) {
+            size_t re_idx = start + i;
+            size_t im_idx = start + seg_len + i;
+            fft_buf[i] = {re_idx < samples_len ? samples[re_idx] : 0,
+                          im_idx < samples_len ? samples[im_idx] : 0};
+        }
+
+        fft_plan->forward(fft_buf.data());
+        for (size_t i = 0; i < fft_size; ++i) {
+            const std::complex<double> &x = fft_buf[i];
+            const std::complex<double> &h = b_spectrum[i];
+            fft_buf[i] = {x.real() * h.real() - x.imag() * h.imag(),
+                          x.real() * h.imag() + x.imag() * h.real()};
+        }
+        fft_plan->inverse(fft_buf.data());
+
+        // The first overlap outputs of each segment are
+        // corrupted by circular wrap-around
+        for (size_t j = 0; j < seg_len && start + j < n; ++j) {
+            out[start + j] = fft_buf[overlap + j].real();
+        }
+        for (size_t j = 0; j < seg_len && start + seg_len + j < n; ++j) {
+            out[start + seg_len + j] = fft_buf[overlap + j].imag();
+        }
+    }
+}
+
+void digital_filter::set_isa(simd_isa isa) {
+    this->isa = isa;
+    dot = fir_kernels::dot(isa);
+    conv = fir_kernels::conv(isa);
+    conv_channels = fir_kernels::conv_channels(isa);
+    use_fft();
+    use_symmetry(symmetry);
+}
+
+void digital_filter::reset() {
+    std::fill(x_hist.begin(), x_hist.end(), 0);
+    std::fill(y_hist.begin(), y_hist.end(), 0);
+    x_pos = 0;
+    y_pos = 0;
+}
+
+void digital_filter::reset_steady(double x) {
+    double b_sum = 0;
+    double a_sum = 0;
+    for (double coeff : b) {
+        b_sum += coeff;
+    }
+    for (double coeff : a) {
+        a_sum += coeff;
+    }
+
+    std::fill(x_hist.begin(), x_hist.end(), x);
+    std::fill(y_hist.begin(), y_hist.end(), x * b_sum / a_sum);
+    x_pos = 0;
+    y_pos = 0;
 }
@@ -5,13 +5,64 @@
 #ifndef TELEM_FILTER_DIGITAL_FILTER_H
 #define TELEM_FILTER_DIGITAL_FILTER_H
 
+#include <complex>
+#include <memory>
 #include <vector>
 
+#include "array_view.h"
+#include "fft.h"
+#include "fir_kernels.h"
+#include "signal_filter.h"
+
+/**
+ * @brief The symmetry of the numerator coefficients of a
+ * linear-phase FIR filter.
+ */
+enum class fir_symmetry {
+    /**
+     * The coefficients have no symmetry.
+     */
+    none,
+    /**
+     * b[k] equals b[N - 1 - k] for every tap.
+     */
+    symmetric,
+    /**
+     * b[k] equals -b[N - 1 - k] for every tap, so the
+     * middle tap of an odd length filter is zero.
+     */
+    antisymmetric
+};
+
 /**
  * @brief Represents a digital filter consisting of the
  * transfer function coefficients.
+ *
+ * Besides transforming whole signals, the filter can be
+ * used as a stateful stream processor which is fed samples
+ * one at a time or in blocks of any size. The history of
+ * the stream is kept in doubled linear buffers: every
+ * sample is written twice, one buffer length apart, so the
+ * most recent samples are always contiguous in memory and
+ * no per-sample shifting or allocation is required.
+ *
+ * The sums over the coefficients are computed with the
+ * widest SIMD kernel the CPU supports, unless another
+ * instruction set is selected with set_isa().
+ *
+ * Numerators with linear-phase symmetry add (or subtract)
+ * each pair of mirrored samples before multiplying by their
+ * shared coefficient, which halves the multiplies.
+ *
+ * FIR filters with many taps convolve large blocks using
+ * FFT overlap-save instead, which costs O(log N) rather
+ * than O(N) operations per sample for N taps.
+ *
+ * Several channels sharing the filter, such as the
+ * components of a velocity, can be transformed together in
+ * a single pass with transform_channels().
  */
-class digital_filter {
+class digital_filter : public signal_filter {
 private:
     /**
      * Filter numerator coefficients.
@@ -22,12 +73,153 @@ private:
      */
     std::vector<double> a;
 
+    /**
+     * The doubled buffer of prior input samples, whose
+     * x_pos-th through (x_pos + b.size() - 1)-th elements
+     * are the most recent inputs from newest to oldest.
+     */
+    std::vector<double> x_hist;
+    /**
+     * The position of the newest input in x_hist.
+     */
+    size_t x_pos{0};
+    /**
+     * The doubled buffer of prior output samples, whose
+     * y_pos-th through (y_pos + a.size() - 1)-th elements
+     * are the most recent outputs from newest to oldest.
+     */
+    std::vector<double> y_hist;
+    /**
+     * The position of the newest output in y_hist.
+     */
+    size_t y_pos{0};
+
+    /**
+     * The numerator coefficients in reverse order, as used
+     * by the block convolution kernel.
+     */
+    std::vector<double> b_rev;
+
+    /**
+     * The symmetry of the numerator coefficients.
+     */
+    fir_symmetry symmetry{fir_symmetry::none};
+    /**
+     * The first (b.size() + 1) / 2 numerator coefficients,
+     * as used by the symmetric dot product kernel.
+     */
+    std::vector<double> b_half;
+    /**
+     * The first (b.size() + 1) / 2 reversed numerator
+     * coefficients, as used by the symmetric block
+     * convolution kernel.
+     */
+    std::vector<double> b_rev_half;
+    /**
+     * Scratch buffer holding the recent input history
+     * followed by the block being filtered. It only grows,
+     * so steady streaming does not allocate.
+     */
+    std::vector<double> block_buf;
+
+    /**
+     * The instruction set used by the kernels.
+     */
+    simd_isa isa{fir_kernels::detect()};
+    /**
+     * The kernel used to sum the coefficient products of a
+     * single sample.
+     */
+    fir_dot_kernel dot{fir_kernels::dot()};
+    /**
+     * The kernel used to convolve whole blocks of input
+     * through FIR filters.
+     */
+    fir_conv_kernel conv{fir_kernels::conv()};
+    /**
+     * The kernel used to sum the numerator products of a
+     * single sample if the numerator is symmetric.
+     */
+    fir_sym_dot_kernel sym_dot{nullptr};
+    /**
+     * The kernel used to convolve whole blocks of input
+     * if the numerator is symmetric.
+     */
+    fir_sym_conv_kernel sym_conv{nullptr};
+    /**
+     * The kernel used to convolve several channels at once
+     * through FIR filters.
+     */
+    fir_conv_channels_kernel conv_channels{fir_kernels::conv_channels(isa)};
+    /**
+     * The kernel used to convolve several channels at once
+     * if the numerator is symmetric.
+     */
+    fir_sym_conv_channels_kernel sym_conv_channels{nullptr};
+
+    /**
+     * The FFT plan used for overlap-save convolution, or
+     * nullptr if the filter is too short to benefit from it
+     * with the selected instruction set.
+     */
+    std::shared_ptr<const fft> fft_plan;
+    /**
+     * The spectrum of the numerator coefficients, zero
+     * padded to the FFT size.
+     */
+    std::vector<std::complex<double>> b_spectrum;
+    /**
+     * Scratch buffer for the overlap-save segments.
+     */
+    std::vector<std::complex<double>> fft_buf;
+
+    /**
+     * Convolves a block of samples with the numerator
+     * coefficients using FFT overlap-save.
+     *
+     * Two consecutive segments are transformed at once as
+     * the real and imaginary parts of a single complex
+     * signal, which is possible because the coefficients
+     * are real.
+     *
+     * @param samples the last b.size() - 1 inputs followed
+     * by the n samples of the block
+     * @param out the n outputs
+     * @param n the number of outputs
+     */
+    void convolve_fft(const double *samples, double *out, size_t n);
+
+    /**
+     * Creates or drops the FFT plan, depending on whether
+     * overlap-save beats the direct kernels of the selected
+     * instruction set for the number of taps.
+     */
+    void use_fft();
+
+    /**
+     * Selects the symmetry of the numerator, which must
+     * match the coefficients, and the kernels exploiting it.
+     *
+     * @param symmetry the numerator symmetry
+     */
+    void use_symmetry(fir_symmetry symmetry);
+
+    /**
+     * Records the next input sample in the input history.
+     *
+     * @param x the input sample
+     */
+    void push_input(double x);
+
 public:
     /**
      * Creates a new filter with the given coefficients.
      *
+     * Symmetry of the numerator is detected automatically.
+     *
      * @param b the numerator coefficients
      * @param a the denominator coefficients
+     * @throws std::invalid_argument if either is empty
      */
     digital_filter(std::vector<double> b,
                    std::vector<double> a);
@@ -39,17 +231,144 @@ public:
      * coefficient is 1.
      *
      * @param b the numerator coefficients
+     * @throws std::invalid_argument if b is empty
      */
     explicit digital_filter(std::vector<double> b);
 
+    /**
+     * Creates a new FIR filter with the given numerator
+     * coefficients and the given symmetry.
+     *
+     * Only the first (b.size() + 1) / 2 coefficients are
+     * used if the filter is symmetric or antisymmetric; the
+     * rest are mirrored from them. A symmetry of none turns
+     * off detection, e.g. to obtain a reference result.
+     *
+     * @param b the numerator coefficients
+     * @param symmetry the symmetry of the coefficients
+     * @throws std::invalid_argument if b is empty
+     */
+    digital_filter(std::vector<double> b, fir_symmetry symmetry);
+
+    /**
+     * Determines the symmetry of the given coefficients,
+     * which must mirror each other exactly.
+     *
+     * @param b the numerator coefficients
+     * @return the symmetry, or none if there are fewer than
+     * two coefficients
+     */
+    static fir_symmetry detect_symmetry(const std::vector<double> &b);
+
     /**
      * Performs a 1-D transformation of the given signal by
      * the filter transfer function.
      *
+     * The transformation starts from rest and does not use
+     * or modify the streaming state of this filter.
+     *
      * @param signal the signal to transform
      * @return the resulting signal
      */
-    std::vector<double> transform(const std::vector<double> &signal);
+    std::vector<double> transform(array_view<const double> signal) const override;
+
+    /**
+     * Performs the transformation of transform() on each
+     * channel of a multi-channel signal.
+     *
+     * FIR filters convolve the channels in place with the
+     * multi-channel kernels, which load and broadcast each
+     * coefficient once per pair of channels with AVX2 and
+     * AVX-512. Other filters, and those using overlap-save
+     * or the scalar instruction set, transform one channel
+     * at a time.
+     *
+     * @param signals the channels to transform, which must
+     * have the same length
+     * @return the resulting channels, in the same order
+     * @throws std::invalid_argument if the channels differ
+     * in length
+     */
+    std::vector<std::vector<double>> transform_channels(
+            const std::vector<array_view<const double>> &signals) const override;
+
+    /**
+     * Performs a zero-phase transformation of the given
+     * signal by filtering it forwards and then backwards,
+     * in the manner of MATLAB's filtfilt().
+     *
+     * The signal is extended at each end by an odd
+     * reflection of 3 * (max(|b|, |a|) - 1) samples, or one
+     * fewer than the signal length if that is shorter, and
+     * each pass starts from the steady state of its first
+     * input. This suppresses transients at the edges and
+     * leaves the output aligned with the input.
+     *
+     * The magnitude response is squared and the phase
+     * response is zero. The streaming state of this filter
+     * is neither used nor modified.
+     *
+     * @param signal the signal to transform
+     * @return the resulting signal
+     */
+    std::vector<double> filtfilt(array_view<const double> signal) const;
+
+    /**
+     * Filters the next sample of the stream.
+     *
+     * @param x the input sample
+     * @return the output sample
+     */
+    double process(double x) override;
+
+    /**
+     * Filters the next block of samples of the stream.
+     *
+     * Feeding a signal through any sequence of blocks
+     * produces the same output as transform(), up to
+     * rounding error when a block convolution kernel is
+     * used. Blocks of FIR filters are convolved several
+     * outputs at a time, unless the scalar instruction set
+     * is selected, or by overlap-save if the filter is
+     * longer than the crossover of the instruction set.
+     *
+     * @param in the input samples
+     * @param out the output samples, which must have the
+     * same length as the input and may be the same array
+     */
+    void process_block(array_view<const double> in, array_view<double> out) override;
+
+    /**
+     * Selects the instruction set used to compute the
+     * filter, e.g. to obtain the scalar reference result,
+     * which sums the taps of every sample in order if the
+     * filter was created without symmetry and is too short
+     * for overlap-save.
+     *
+     * The crossover to overlap-save depends on the
+     * instruction set, so it is re-evaluated here.
+     *
+     * @param isa the instruction set, which must be
+     * supported by the CPU
+     */
+    void set_isa(simd_isa isa);
+
+    /**
+     * Resets the stream to rest, clearing the history of
+     * prior inputs and outputs.
+     */
+    void reset() override;
+
+    /**
+     * Resets the stream to the steady state reached after
+     * an infinitely long constant input, as if every prior
+     * input had the given value.
+     *
+     * The filter must not have a pole at DC.
+     *
+     * @param x the value of the prior inputs
+     */
+    void reset_steady(double x);
 };
 
 #endif // TELEM_FILTER_DIGITAL_FILTER_H
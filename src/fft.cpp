@@ -0,0 +1,89 @@
+#include "fft.h"
+
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+fft::fft(size_t n) :
+        n(n), twiddles(n / 2), bit_reversed(n) {
+    if (n == 0 || (n & (n - 1)) != 0) {
+        throw std::invalid_argument{"FFT size must be a power of two."};
+    }
+
+    for (size_t k = 0; k < n / 2; ++k) {
+        double angle = -2 * M_PI * static_cast<double>(k) / static_cast<double>(n);
+        twiddles[k] = {std::cos(angle), std::sin(angle)};
+    }
+
+    size_t bits = 0;
+    while ((size_t{1} << bits) < n) {
+        ++bits;
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        size_t rev = 0;
+        for (size_t b = 0; b < bits; ++b) {
+            rev |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        bit_reversed[i] = rev;
+    }
+}
+
+size_t fft::size() const {
+    return n;
+}
+
+void fft::transform(std::complex<double> *data, bool inverse) const {
+    for (size_t i = 0; i < n; ++i) {
+        size_t j = bit_reversed[i];
+        if (i < j) {
+            std::swap(data[i], data[j]);
+        }
+    }
+
+    // The complex products are written out by hand, since
+    // std::complex multiplication checks for NaN results
+    // unless compiled with relaxed floating-point semantics
+    double sign = inverse ? -1 : 1;
+    for (size_t len = 2; len <= n; len <<= 1) {
+        size_t half = len / 2;
+        size_t stride = n / len;
+        for (size_t start = 0; start < n; start += len) {
+            for (size_t k = 0; k < half; ++k) {
+                const std::complex<double> &w = twiddles[k * stride];
+                double w_re = w.real();
+                double w_im = sign * w.imag();
+
+                std::complex<double> &top = data[start + k];
+                std::complex<double> &bottom = data[start + k + half];
+                double t_re = w_re * bottom.real() - w_im * bottom.imag();
+                double t_im = w_re * bottom.imag() + w_im * bottom.real();
+
+                bottom = {top.real() - t_re, top.imag() - t_im};
+                top = {top.real() + t_re, top.imag() + t_im};
+            }
+        }
+    }
+}
+
+void fft::forward(std::complex<double> *data) const {
+    transform(data, false);
+}
+
+void fft::inverse(std::complex<double> *data) const {
+    transform(data, true);
+
+    double scale = 1.0 / static_cast<double>(n);
+    for (size_t i = 0; i < n; ++i) {
+        data[i] *= scale;
+    }
+}
+
+size_t fft::next_size(size_t size) {
+    size_t n = 1;
+    while (n < size) {
+        n <<= 1;
+    }
+
+    return n;
+}
@@ -0,0 +1,84 @@
+/**
+ * @file
+ */
+
+#ifndef TELEM_FILTER_FFT_H
+#define TELEM_FILTER_FFT_H
+
+#include <complex>
+#include <vector>
+
+/**
+ * @brief A precomputed plan for in-place complex fast
+ * Fourier transforms of a fixed power-of-two size.
+ *
+ * The transform is an iterative radix-2 decimation in time.
+ * Plans are immutable once created and may be shared
+ * between threads.
+ */
+class fft {
+private:
+    /**
+     * The transform size.
+     */
+    size_t n;
+    /**
+     * The twiddle factors exp(-2 pi i k / n) for k < n / 2.
+     */
+    std::vector<std::complex<double>> twiddles;
+    /**
+     * The bit-reversed index of each element.
+     */
+    std::vector<size_t> bit_reversed;
+
+    /**
+     * Performs the butterflies of the transform in place.
+     *
+     * @param data the n elements to transform
+     * @param inverse whether to use conjugated twiddles
+     */
+    void transform(std::complex<double> *data, bool inverse) const;
+
+public:
+    /**
+     * Creates a plan for transforms of the given size.
+     *
+     * @param n the transform size
+     * @throws std::invalid_argument if n is not a power of
+     * two
+     */
+    explicit fft(size_t n);
+
+    /**
+     * Obtains the size of the transforms of this plan.
+     *
+     * @return the number of elements transformed
+     */
+    [[nodiscard]] size_t size() const;
+
+    /**
+     * Performs the forward transform in place.
+     *
+     * @param data the size() elements to transform
+     */
+    void forward(std::complex<double> *data) const;
+
+    /**
+     * Performs the inverse transform in place, including the
+     * 1 / n normalization.
+     *
+     * @param data the size() elements to transform
+     */
+    void inverse(std::complex<double> *data) const;
+
+    /**
+     * Determines the smallest power of two that is at least
+     * the given size.
+     *
+     * @param size the minimum transform size
+     * @return the power of two
+     */
+    static size_t next_size(size_t size);
+};
+
+#endif // TELEM_FILTER_FFT_H
@@ -0,0 +1,1079 @@
+#include "fir_kernels.h"
+
+#ifdef TELEM_FILTER_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * Scalar reference dot product, summing in index order.
+ *
+ * @param coeffs the coefficients
+ * @param samples the samples
+ * @param n the number of products
+ * @return the dot product
+ */
+static double dot_scalar(const double *coeffs, const double *samples, size_t n) {
+    double sum = 0;
+    for (size_t i = 0; i < n; ++i) {
+        sum += coeffs[i] * samples[i];
+    }
+
+    return sum;
+}
+
+/**
+ * Scalar reference block convolution.
+ *
+ * @param coeffs the reversed coefficients
+ * @param taps the number of coefficients
+ * @param samples the samples, of length n + taps - 1
+ * @param out the n outputs
+ * @param n the number of outputs
+ */
+static void conv_scalar(const double *coeffs, size_t taps,
+                        const double *samples, double *out, size_t n) {
+    for (size_t j = 0; j < n; ++j) {
+        out[j] = dot_scalar(coeffs, samples + j, taps);
+    }
+}
+
+/**
+ * Combines a sample with its mirror image according to the
+ * filter symmetry.
+ *
+ * @tparam anti whether the filter is antisymmetric
+ * @param x the sample
+ * @param mirror the mirrored sample
+ * @return the sum, or the difference if antisymmetric
+ */
+template<bool anti>
+static double mirror_combine(double x, double mirror) {
+    return anti ? x - mirror : x + mirror;
+}
+
+/**
+ * Scalar linear-phase dot product.
+ *
+ * @tparam anti whether the filter is antisymmetric
+ * @param half_coeffs the first (taps + 1) / 2 coefficients
+ * @param samples the taps samples
+ * @param taps the length of the filter
+ * @return the filter output
+ */
+template<bool anti>
+static double sym_dot_scalar(const double *half_coeffs, const double *samples, size_t taps) {
+    size_t half = taps / 2;
+    double sum = 0;
+    for (size_t k = 0; k < half; ++k) {
+        sum += half_coeffs[k] * mirror_combine<anti>(samples[k], samples[taps - 1 - k]);
+    }
+    if (taps % 2 != 0) {
+        sum += half_coeffs[half] * samples[half];
+    }
+
+    return sum;
+}
+
+/**
+ * Scalar linear-phase block convolution.
+ *
+ * @tparam anti whether the filter is antisymmetric
+ * @param half_coeffs the first (taps + 1) / 2 reversed
+ * coefficients
+ * @param taps the length of the filter
+ * @param samples the samples, of length n + taps - 1
+ * @param out the n outputs
+ * @param n the number of outputs
+ */
+template<bool anti>
+static void sym_conv_scalar(const double *half_coeffs, size_t taps,
+                            const double *samples, double *out, size_t n) {
+    for (size_t j = 0; j < n; ++j) {
+        out[j] = sym_dot_scalar<anti>(half_coeffs, samples + j, taps);
+    }
+}
+
+/**
+ * A kernel that convolves blocks of two channels with the
+ * same coefficients, as a fir_conv_channels_kernel does for
+ * samples[0] and samples[1].
+ */
+using conv_pair_kernel = void (*)(const double *coeffs, size_t taps,
+                                  const double *const *samples, double *const *out, size_t n);
+
+/**
+ * Convolves the channels one at a time.
+ *
+ * @tparam single the single-channel kernel
+ * @param coeffs the reversed coefficients, or their first
+ * half for the linear-phase kernels
+ * @param taps the length of the filter
+ * @param samples the samples of each channel, of length
+ * n + taps - 1
+ * @param out the n outputs of each channel
+ * @param channels the number of channels
+ * @param n the number of outputs per channel
+ */
+template<fir_conv_kernel single>
+static void conv_each(const double *coeffs, size_t taps,
+                      const double *const *samples, double *const *out,
+                      size_t channels, size_t n) {
+    for (size_t c = 0; c < channels; ++c) {
+        single(coeffs, taps, samples[c], out[c], n);
+    }
+}
+
+/**
+ * Convolves the channels two at a time, and the last of an
+ * odd number of channels on its own.
+ *
+ * @tparam pair the two-channel kernel
+ * @tparam single the single-channel kernel
+ * @param coeffs the reversed coefficients, or their first
+ * half for the linear-phase kernels
+ * @param taps the length of the filter
+ * @param samples the samples of each channel, of length
+ * n + taps - 1
+ * @param out the n outputs of each channel
+ * @param channels the number of channels
+ * @param n the number of outputs per channel
+ */
+template<conv_pair_kernel pair, fir_conv_kernel single>
+static void conv_pairs(const double *coeffs, size_t taps,
+                       const double *const *samples, double *const *out,
+                       size_t channels, size_t n) {
+    size_t c = 0;
+    for (; c + 2 <= channels; c += 2) {
+        pair(coeffs, taps, samples + c, out + c, n);
+    }
+    if (c < channels) {
+        single(coeffs, taps, samples[c], out[c], n);
+    }
+}
+
+#ifdef TELEM_FILTER_X86
+
+/**
+ * Combines two SSE2 vectors of samples and their mirror
+ * images according to the filter symmetry.
+ *
+ * @tparam anti whether the filter is antisymmetric
+ * @param x the samples
+ * @param mirror the mirrored samples
+ * @return the sums, or the differences if antisymmetric
+ */
+template<bool anti>
+__attribute__((target("sse2")))
+static __m128d mirror_combine(__m128d x, __m128d mirror) {
+    return anti ? _mm_sub_pd(x, mirror) : _mm_add_pd(x, mirror);
+}
+
+/**
+ * Combines two AVX vectors of samples and their mirror
+ * images according to the filter symmetry.
+ *
+ * @tparam anti whether the filter is antisymmetric
+ * @param x the samples
+ * @param mirror the mirrored samples
+ * @return the sums, or the differences if antisymmetric
+ */
+template<bool anti>
+__attribute__((target("avx2")))
+static __m256d mirror_combine(__m256d x, __m256d mirror) {
+    return anti ? _mm256_sub_pd(x, mirror) : _mm256_add_pd(x, mirror);
+}
+
+/**
+ * Combines two AVX-512 vectors of samples and their mirror
+ * images according to the filter symmetry.
+ *
+ * @tparam anti whether the filter is antisymmetric
+ * @param x the samples
+ * @param mirror the mirrored samples
+ * @return the sums, or the differences if antisymmetric
+ */
+template<bool anti>
+__attribute__((target("avx512f")))
+static __m512d mirror_combine(__m512d x, __m512d mirror) {
+    return anti ? _mm512_sub_pd(x, mirror) : _mm512_add_pd(x, mirror);
+}
+
+/**
+ * SSE2 dot product using two vector accumulators.
+ *
+ * @param coeffs the coefficients
+ * @param samples the samples
+ * @param n the number of products
+ * @return the dot product
+ */
+__attribute__((target("sse2")))
+static double dot_sse2(const double *coeffs, const double *samples, size_t n) {
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(coeffs + i), _mm_loadu_pd(samples + i)));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(coeffs + i + 2), _mm_loadu_pd(samples + i + 2)));
+    }
+
+    __m128d acc = _mm_add_pd(acc0, acc1);
+    double sum = _mm_cvtsd_f64(_mm_add_sd(acc, _mm_unpackhi_pd(acc, acc)));
+    for (; i < n; ++i) {
+        sum += coeffs[i] * samples[i];
+    }
+
+    return sum;
+}
+
+/**
+ * AVX2 dot product using four fused multiply-add
+ * accumulators.
+ *
+ * @param coeffs the coefficients
+ * @param samples the samples
+ * @param n the number of products
+ * @return the dot product
+ */
+__attribute__((target("avx2,fma")))
+static double dot_avx2(const double *coeffs, const double *samples, size_t n) {
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    __m256d acc2 = _mm256_setzero_pd();
+    __m256d acc3 = _mm256_setzero_pd();
+
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(coeffs + i), _mm256_loadu_pd(samples + i), acc0);
+        acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(coeffs + i + 4), _mm256_loadu_pd(samples + i + 4), acc1);
+        acc2 = _mm256_fmadd_pd(_mm256_loadu_pd(coeffs + i + 8), _mm256_loadu_pd(samples + i + 8), acc2);
+        acc3 = _mm256_fmadd_pd(_mm256_loadu_pd(coeffs + i + 12), _mm256_loadu_pd(samples + i + 12), acc3);
+    }
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(coeffs + i), _mm256_loadu_pd(samples + i), acc0);
+    }
+
+    __m256d acc = _mm256_add_pd(_mm256_add_pd(acc0, acc1), _mm256_add_pd(acc2, acc3));
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1));
+    double sum = _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+    for (; i < n; ++i) {
+        sum += coeffs[i] * samples[i];
+    }
+
+    return sum;
+}
+
+/**
+ * AVX-512 dot product using two fused multiply-add
+ * accumulators and a masked tail.
+ *
+ * @param coeffs the coefficients
+ * @param samples the samples
+ * @param n the number of products
+ * @return the dot product
+ */
+__attribute__((target("avx512f")))
+static double dot_avx512(const double *coeffs, const double *samples, size_t n) {
+    __m512d acc0 = _mm512_setzero_pd();
+    __m512d acc1 = _mm512_setzero_pd();
+
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(coeffs + i), _mm512_loadu_pd(samples + i), acc0);
+        acc1 = _mm512_fmadd_pd(_mm512_loadu_pd(coeffs + i + 8), _mm512_loadu_pd(samples + i + 8), acc1);
+    }
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(coeffs + i), _mm512_loadu_pd(samples + i), acc0);
+    }
+    if (i < n) {
+        auto mask = static_cast<__mmask8>((1U << (n - i)) - 1);
+        acc1 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, coeffs + i),
+                               _mm512_maskz_loadu_pd(mask, samples + i), acc1);
+    }
+
+    return _mm512_reduce_add_pd(_mm512_add_pd(acc0, acc1));
+}
+
+/**
+ * SSE2 block convolution computing 8 outputs per pass over
+ * the coefficients.
+ *
+ * @param coeffs the reversed coefficients
+ * @param taps the number of coefficients
+ * @param samples the samples, of length n + taps - 1
+ * @param out the n outputs
+ * @param n the number of outputs
+ */
+__attribute__((target("sse2")))
+static void conv_sse2(const double *coeffs, size_t taps,
+                      const double *samples, double *out, size_t n) {
+    size_t j = 0;
+    for (; j + 8 <= n; j += 8) {
+        __m128d acc0 = _mm_setzero_pd();
+        __m128d acc1 = _mm_setzero_pd();
+        __m128d acc2 = _mm_setzero_pd();
+        __m128d acc3 = _mm_setzero_pd();
+
+        const double *x = samples + j;
+        for (size_t k = 0; k < taps; ++k) {
+            __m128d c = _mm_set1_pd(coeffs[k]);
+            acc0 = _mm_add_pd(acc0, _mm_mul_pd(c, _mm_loadu_pd(x + k)));
+            acc1 = _mm_add_pd(acc1, _mm_mul_pd(c, _mm_loadu_pd(x + k + 2)));
+            acc2 = _mm_add_pd(acc2, _mm_mul_pd(c, _mm_loadu_pd(x + k + 4)));
+            acc3 = _mm_add_pd(acc3, _mm_mul_pd(c, _mm_loadu_pd(x + k + 6)));
+        }
+
+        _mm_storeu_pd(out + j, acc0);
+        _mm_storeu_pd(out + j + 2, acc1);
+        _mm_storeu_pd(out + j + 4, acc2);
+        _mm_storeu_pd(out + j + 6, acc3);
+    }
+
+    conv_scalar(coeffs, taps, samples + j, out + j, n - j);
+}
+
+/**
+ * AVX2 block convolution computing 16 outputs per pass over
+ * the coefficients.
+ *
+ * @param coeffs the reversed coefficients
+ * @param taps the number of coefficients
+ * @param samples the samples, of length n + taps - 1
+ * @param out the n outputs
+ * @param n the number of outputs
+ */
+__attribute__((target("avx2,fma")))
+static void conv_avx2(const double *coeffs, size_t taps,
+                      const double *samples, double *out, size_t n) {
+    size_t j = 0;
+    for (; j + 16 <= n; j += 16) {
+        __m256d acc0 = _mm256_setzero_pd();
+        __m256d acc1 = _mm256_setzero_pd();
+        __m256d acc2 = _mm256_setzero_pd();
+        __m256d acc3 = _mm256_setzero_pd();
+
+        const double *x = samples + j;
+        for (size_t k = 0; k < taps; ++k) {
+            __m256d c = _mm256_broadcast_sd(coeffs + k);
+            acc0 = _mm256_fmadd_pd(c, _mm256_loadu_pd(x + k), acc0);
+            acc1 = _mm256_fmadd_pd(c, _mm256_loadu_pd(x + k + 4), acc1);
+            acc2 = _mm256_fmadd_pd(c, _mm256_loadu_pd(x + k + 8), acc2);
+            acc3 = _mm256_fmadd_pd(c, _mm256_loadu_pd(x + k + 12), acc3);
+        }
+
+        _mm256_storeu_pd(out + j, acc0);
+        _mm256_storeu_pd(out + j + 4, acc1);
+        _mm256_storeu_pd(out + j + 8, acc2);
+        _mm256_storeu_pd(out + j + 12, acc3);
+    }
+
+    conv_scalar(coeffs, taps, samples + j, out + j, n - j);
+}
+
+/**
+ * AVX-512 block convolution computing 32 outputs per pass
+ * over the coefficients.
+ *
+ * @param coeffs the reversed coefficients
+ * @param taps the number of coefficients
+ * @param samples the samples, of length n + taps - 1
+ * @param out the n outputs
+ * @param n the number of outputs
+ */
+__attribute__((target("avx512f")))
+static void conv_avx512(const double *coeffs, size_t taps,
+                        const double *samples, double *out, size_t n) {
+    size_t j = 0;
+    for (; j + 32 <= n; j += 32) {
+        __m512d acc0 = _mm512_setzero_pd();
+        __m512d acc1 = _mm512_setzero_pd();
+        __m512d acc2 = _mm512_setzero_pd();
+        __m512d acc3 = _mm512_setzero_pd();
+
+        const double *x = samples + j;
+        for (size_t k = 0; k < taps; ++k) {
+            __m512d c = _mm512_set1_pd(coeffs[k]);
+            acc0 = _mm512_fmadd_pd(c, _mm512_loadu_pd(x + k), acc0);
+            acc1 = _mm512_fmadd_pd(c, _mm512_loadu_pd(x + k + 8), acc1);
+            acc2 = _mm512_fmadd_pd(c, _mm512_loadu_pd(x + k + 16), acc2);
+            acc3 = _mm512_fmadd_pd(c, _mm512_loadu_pd(x + k + 24), acc3);
+        }
+
+        _mm512_storeu_pd(out + j, acc0);
+        _mm512_storeu_pd(out + j + 8, acc1);
+        _mm512_storeu_pd(out + j + 16, acc2);
+        _mm512_storeu_pd(out + j + 24, acc3);
+    }
+
+    conv_avx2(coeffs, taps, samples + j, out + j, n - j);
+}
+
+/**
+ * SSE2 linear-phase dot product.
+ *
+ * @tparam anti whether the filter is antisymmetric
+ * @param half_coeffs the first (taps + 1) / 2 coefficients
+ * @param samples the taps samples
+ * @param taps the length of the filter
+ * @return the filter output
+ */
+template<bool anti>
+__attribute__((target("sse2")))
+static double sym_dot_sse2(const double *half_coeffs, const double *samples, size_t taps) {
+    size_t half = taps / 2;
+    __m128d acc = _mm_setzero_pd();
+
+    size_t k = 0;
+    for (; k + 2 <= half; k += 2) {
+        __m128d x = _mm_loadu_pd(samples + k);
+        __m128d mirror = _mm_loadu_pd(samples + taps - 2 - k);
+        mirror = _mm_shuffle_pd(mirror, mirror, 1);
+        acc = _mm_add_pd(acc, _mm_mul_pd(_mm_loadu_pd(half_coeffs + k), mirror_combine<anti>(x, mirror)));
+    }
+
+    double sum = _mm_cvtsd_f64(_mm_add_sd(acc, _mm_unpackhi_pd(acc, acc)));
+    for (; k < half; ++k) {
+        sum += half_coeffs[k] * mirror_combine<anti>(samples[k], samples[taps - 1 - k]);
+    }
+    if (taps % 2 != 0) {
+        sum += half_coeffs[half] * samples[half];
+    }
+
+    return sum;
+}
+
+/**
+ * AVX2 linear-phase dot product.
+ *
+ * @tparam anti whether the filter is antisymmetric
+ * @param half_coeffs the first (taps + 1) / 2 coefficients
+ * @param samples the taps samples
+ * @param taps the length of the filter
+ * @return the filter output
+ */
+template<bool anti>
+__attribute__((target("avx2,fma")))
+static double sym_dot_avx2(const double *half_coeffs, const double *samples, size_t taps) {
+    size_t half = taps / 2;
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    const double *m = samples + taps - 4;
+    size_t k = 0;
+    for (; k + 8 <= half; k += 8) {
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(half_coeffs + k),
+                               mirror_combine<anti>(_mm256_loadu_pd(samples + k),
+                                                    _mm256_permute4x64_pd(_mm256_loadu_pd(m - k), 0x1B)), acc0);
+        acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(half_coeffs + k + 4),
+                               mirror_combine<anti>(_mm256_loadu_pd(samples + k + 4),
+                                                    _mm256_permute4x64_pd(_mm256_loadu_pd(m - k - 4), 0x1B)), acc1);
+    }
+    if (k + 4 <= half) {
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(half_coeffs + k),
+                               mirror_combine<anti>(_mm256_loadu_pd(samples + k),
+                                                    _mm256_permute4x64_pd(_mm256_loadu_pd(m - k), 0x1B)), acc0);
+        k += 4;
+    }
+
+    __m256d acc = _mm256_add_pd(acc0, acc1);
+    __m128d half_acc = _mm_add_pd(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1));
+    double sum = _mm_cvtsd_f64(_mm_add_sd(half_acc, _mm_unpackhi_pd(half_acc, half_acc)));
+    for (; k < half; ++k) {
+        sum += half_coeffs[k] * mirror_combine<anti>(samples[k], samples[taps - 1 - k]);
+    }
+    if (taps % 2 != 0) {
+        sum += half_coeffs[half] * samples[half];
+    }
+
+    return sum;
+}
+
+/**
+ * AVX-512 linear-phase dot product.
+ *
+ * @tparam anti whether the filter is antisymmetric
+ * @param half_coeffs the first (taps + 1) / 2 coefficients
+ * @param samples the taps samples
+ * @param taps the length of the filter
+ * @return the filter output
+ */
+template<bool anti>
+__attribute__((target("avx512f")))
+static double sym_dot_avx512(const double *half_coeffs, const double *samples, size_t taps) {
+    size_t half = taps / 2;
+    const __m512i reverse = _mm512_set_epi64(0, 1, 2, 3, 4, 5, 6, 7);
+    const double *m = samples + taps - 8;
+    __m512d acc0 = _mm512_setzero_pd();
+    __m512d acc1 = _mm512_setzero_pd();
+
+    size_t k = 0;
+    for (; k + 16 <= half; k += 16) {
+        acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(half_coeffs + k),
+                               mirror_combine<anti>(_mm512_loadu_pd(samples + k),
+                                                    _mm512_permutexvar_pd(reverse, _mm512_loadu_pd(m - k))),
+                               acc0);
+        acc1 = _mm512_fmadd_pd(_mm512_loadu_pd(half_coeffs + k + 8),
+                               mirror_combine<anti>(_mm512_loadu_pd(samples + k + 8),
+                                                    _mm512_permutexvar_pd(reverse, _mm512_loadu_pd(m - k - 8))),
+                               acc1);
+    }
+    for (; k + 8 <= half; k += 8) {
+        acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(half_coeffs + k),
+                               mirror_combine<anti>(_mm512_loadu_pd(samples + k),
+                                                    _mm512_permutexvar_pd(reverse, _mm512_loadu_pd(m - k))),
+                               acc0);
+    }
+    if (k < half) {
+        // The mirrored samples of the tail are the top lanes
+        // of the load, which land in the bottom lanes once
+        // reversed
+        size_t rem = half - k;
+        auto mask = static_cast<__mmask8>((1U << rem) - 1);
+        auto mirror_mask = static_cast<__mmask8>(mask << (8 - rem));
+        acc1 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, half_coeffs + k),
+                               mirror_combine<anti>(_mm512_maskz_loadu_pd(mask, samples + k),
+                                                    _mm512_permutexvar_pd(reverse,
+                                                                          _mm512_maskz_loadu_pd(mirror_mask, m - k))),
+                               acc1);
+    }
+
+    double sum = _mm512_reduce_add_pd(_mm512_add_pd(acc0, acc1));
+    if (taps % 2 != 0) {
+        sum += half_coeffs[half] * samples[half];
+    }
+
+    return sum;
+}
+
+/**
+ * SSE2 linear-phase block convolution computing 8 outputs
+ * per pass over the coefficients.
+ *
+ * @tparam anti whether the filter is antisymmetric
+ * @param half_coeffs the first (taps + 1) / 2 reversed
+ * coefficients
+ * @param taps the length of the filter
+ * @param samples the samples, of length n + taps - 1
+ * @param out the n outputs
+ * @param n the number of outputs
+ */
+template<bool anti>
+__attribute__((target("sse2")))
+static void sym_conv_sse2(const double *half_coeffs, size_t taps,
+                          const double *samples, double *out, size_t n) {
+    size_t half = taps / 2;
+    size_t j = 0;
+    for (; j + 8 <= n; j += 8) {
+        __m128d acc0 = _mm_setzero_pd();
+        __m128d acc1 = _mm_setzero_pd();
+        __m128d acc2 = _mm_setzero_pd();
+        __m128d acc3 = _mm_setzero_pd();
+
+        const double *x = samples + j;
+        const double *m = x + taps - 1;
+        for (size_t k = 0; k < half; ++k) {
+            __m128d c = _mm_set1_pd(half_coeffs[k]);
+            acc0 = _mm_add_pd(acc0, _mm_mul_pd(c, mirror_combine<anti>(_mm_loadu_pd(x + k), _mm_loadu_pd(m - k))));
+            acc1 = _mm_add_pd(acc1, _mm_mul_pd(c, mirror_combine<anti>(_mm_loadu_pd(x + k + 2), _mm_loadu_pd(m - k + 2))));
+            acc2 = _mm_add_pd(acc2, _mm_mul_pd(c, mirror_combine<anti>(_mm_loadu_pd(x + k + 4), _mm_loadu_pd(m - k + 4))));
+            acc3 = _mm_add_pd(acc3, _mm_mul_pd(c, mirror_combine<anti>(_mm_loadu_pd(x + k + 6), _mm_loadu_pd(m - k + 6))));
+        }
+        if (taps % 2 != 0) {
+            __m128d c = _mm_set1_pd(half_coeffs[half]);
+            acc0 = _mm_add_pd(acc0, _mm_mul_pd(c, _mm_loadu_pd(x + half)));
+            acc1 = _mm_add_pd(acc1, _mm_mul_pd(c, _mm_loadu_pd(x + half + 2)));
+            acc2 = _mm_add_pd(acc2, _mm_mul_pd(c, _mm_loadu_pd(x + half + 4)));
+            acc3 = _mm_add_pd(acc3, _mm_mul_pd(c, _mm_loadu_pd(x + half + 6)));
+        }
+
+        _mm_storeu_pd(out + j, acc0);
+        _mm_storeu_pd(out + j + 2, acc1);
+        _mm_storeu_pd(out + j + 4, acc2);
+        _mm_storeu_pd(out + j + 6, acc3);
+    }
+
+    sym_conv_scalar<anti>(half_coeffs, taps, samples + j, out + j, n - j);
+}
+
+/**
+ * AVX2 linear-phase block convolution computing 16 outputs
+ * per pass over the coefficients.
+ *
+ * @tparam anti whether the filter is antisymmetric
+ * @param half_coeffs the first (taps + 1) / 2 reversed
+ * coefficients
+ * @param taps the length of the filter
+ * @param samples the samples, of length n + taps - 1
+ * @param out the n outputs
+ * @param n the number of outputs
+ */
+template<bool anti>
+__attribute__((target("avx2,fma")))
+static void sym_conv_avx2(const double *half_coeffs, size_t taps,
+                          const double *samples, double *out, size_t n) {
+    size_t half = taps / 2;
+    size_t j = 0;
+    for (; j + 16 <= n; j += 16) {
+        __m256d acc0 = _mm256_setzero_pd();
+        __m256d acc1 = _mm256_setzero_pd();
+        __m256d acc2 = _mm256_setzero_pd();
+        __m256d acc3 = _mm256_setzero_pd();
+
+        const double *x = samples + j;
+        const double *m = x + taps - 1;
+        for (size_t k = 0; k < half; ++k) {
+            __m256d c = _mm256_broadcast_sd(half_coeffs + k);
+            acc0 = _mm256_fmadd_pd(c, mirror_combine<anti>(_mm256_loadu_pd(x + k), _mm256_loadu_pd(m - k)), acc0);
+            acc1 = _mm256_fmadd_pd(c, mirror_combine<anti>(_mm256_loadu_pd(x + k + 4), _mm256_loadu_pd(m - k + 4)), acc1);
+            acc2 = _mm256_fmadd_pd(c, mirror_combine<anti>(_mm256_loadu_pd(x + k + 8), _mm256_loadu_pd(m - k + 8)), acc2);
+            acc3 = _mm256_fmadd_pd(c, mirror_combine<anti>(_mm256_loadu_pd(x + k + 12), _mm256_loadu_pd(m - k + 12)), acc3);
+        }
+        if (taps % 2 != 0) {
+            __m256d c = _mm256_broadcast_sd(half_coeffs + half);
+            acc0 = _mm256_fmadd_pd(c, _mm256_loadu_pd(x + half), acc0);
+            acc1 = _mm256_fmadd_pd(c, _mm256_loadu_pd(x + half + 4), acc1);
+            acc2 = _mm256_fmadd_pd(c, _mm256_loadu_pd(x + half + 8), acc2);
+            acc3 = _mm256_fmadd_pd(c, _mm256_loadu_pd(x + half + 12), acc3);
+        }
+
+        _mm256_storeu_pd(out + j, acc0);
+        _mm256_storeu_pd(out + j + 4, acc1);
+        _mm256_storeu_pd(out + j + 8, acc2);
+        _mm256_storeu_pd(out + j + 12, acc3);
+    }
+
+    sym_conv_scalar<anti>(half_coeffs, taps, samples + j, out + j, n - j);
+}
+
+/**
+ * AVX-512 linear-phase block convolution computing 32
+ * outputs per pass over the coefficients.
+ *
+ * @tparam anti whether the filter is antisymmetric
+ * @param half_coeffs the first (taps + 1) / 2 reversed
+ * coefficients
+ * @param taps the length of the filter
+ * @param samples the samples, of length n + taps - 1
+ * @param out the n outputs
+ * @param n the number of outputs
+ */
+template<bool anti>
+__attribute__((target("avx512f")))
+static void sym_conv_avx512(const double *half_coeffs, size_t taps,
+                            const double *samples, double *out, size_t n) {
+    size_t half = taps / 2;
+    size_t j = 0;
+    for (; j + 32 <= n; j += 32) {
+        __m512d acc0 = _mm512_setzero_pd();
+        __m512d acc1 = _mm512_setzero_pd();
+        __m512d acc2 = _mm512_setzero_pd();
+        __m512d acc3 = _mm512_setzero_pd();
+
+        const double *x = samples + j;
+        const double *m = x + taps - 1;
+        for (size_t k = 0; k < half; ++k) {
+            __m512d c = _mm512_set1_pd(half_coeffs[k]);
+            acc0 = _mm512_fmadd_pd(c, mirror_combine<anti>(_mm512_loadu_pd(x + k), _mm512_loadu_pd(m - k)), acc0);
+            acc1 = _mm512_fmadd_pd(c, mirror_combine<anti>(_mm512_loadu_pd(x + k + 8), _mm512_loadu_pd(m - k + 8)), acc1);
+            acc2 = _mm512_fmadd_pd(c, mirror_combine<anti>(_mm512_loadu_pd(x + k + 16), _mm512_loadu_pd(m - k + 16)), acc2);
+            acc3 = _mm512_fmadd_pd(c, mirror_combine<anti>(_mm512_loadu_pd(x + k + 24), _mm512_loadu_pd(m - k + 24)), acc3);
+        }
+        if (taps % 2 != 0) {
+            __m512d c = _mm512_set1_pd(half_coeffs[half]);
+            acc0 = _mm512_fmadd_pd(c, _mm512_loadu_pd(x + half), acc0);
+            acc1 = _mm512_fmadd_pd(c, _mm512_loadu_pd(x + half + 8), acc1);
+            acc2 = _mm512_fmadd_pd(c, _mm512_loadu_pd(x + half + 16), acc2);
+            acc3 = _mm512_fmadd_pd(c, _mm512_loadu_pd(x + half + 24), acc3);
+        }
+
+        _mm512_storeu_pd(out + j, acc0);
+        _mm512_storeu_pd(out + j + 8, acc1);
+        _mm512_storeu_pd(out + j + 16, acc2);
+        _mm512_storeu_pd(out + j + 24, acc3);
+    }
+
+    sym_conv_avx2<anti>(half_coeffs, taps, samples + j, out + j, n - j);
+}
+
+/**
+ * AVX2 block convolution of two channels computing
+ * 16 outputs of each per pass over the coefficients.
+ *
+ * @param coeffs the reversed coefficients
+ * @param taps the number of coefficients
+ * @param samples the samples of the two channels, of length
+ * n + taps - 1
+ * @param out the n outputs of the two channels
+ * @param n the number of outputs per channel
+ */
+__attribute__((target("avx2,fma")))
+static void conv_pair_avx2(const double *coeffs, size_t taps,
+                           const double *const *samples, double *const *out, size_t n) {
+    size_t j = 0;
+    for (; j + 16 <= n; j += 16) {
+        __m256d x_acc0 = _mm256_setzero_pd();
+        __m256d x_acc1 = _mm256_setzero_pd();
+        __m256d x_acc2 = _mm256_setzero_pd();
+        __m256d x_acc3 = _mm256_setzero_pd();
+        __m256d y_acc0 = _mm256_setzero_pd();
+        __m256d y_acc1 = _mm256_setzero_pd();
+        __m256d y_acc2 = _mm256_setzero_pd();
+        __m256d y_acc3 = _mm256_setzero_pd();
+
+        const double *x = samples[0] + j;
+        const double *y = samples[1] + j;
+        for (size_t k = 0; k < taps; ++k) {
+            __m256d c = _mm256_broadcast_sd(coeffs + k);
+            x_acc0 = _mm256_fmadd_pd(c, _mm256_loadu_pd(x + k), x_acc0);
+            x_acc1 = _mm256_fmadd_pd(c, _mm256_loadu_pd(x + k + 4), x_acc1);
+            x_acc2 = _mm256_fmadd_pd(c, _mm256_loadu_pd(x + k + 8), x_acc2);
+            x_acc3 = _mm256_fmadd_pd(c, _mm256_loadu_pd(x + k + 12), x_acc3);
+            y_acc0 = _mm256_fmadd_pd(c, _mm256_loadu_pd(y + k), y_acc0);
+            y_acc1 = _mm256_fmadd_pd(c, _mm256_loadu_pd(y + k + 4), y_acc1);
+            y_acc2 = _mm256_fmadd_pd(c, _mm256_loadu_pd(y + k + 8), y_acc2);
+            y_acc3 = _mm256_fmadd_pd(c, _mm256_loadu_pd(y + k + 12), y_acc3);
+        }
+
+        _mm256_storeu_pd(out[0] + j, x_acc0);
+        _mm256_storeu_pd(out[0] + j + 4, x_acc1);
+        _mm256_storeu_pd(out[0] + j + 8, x_acc2);
+        _mm256_storeu_pd(out[0] + j + 12, x_acc3);
+        _mm256_storeu_pd(out[1] + j, y_acc0);
+        _mm256_storeu_pd(out[1] + j + 4, y_acc1);
+        _mm256_storeu_pd(out[1] + j + 8, y_acc2);
+        _mm256_storeu_pd(out[1] + j + 12, y_acc3);
+    }
+
+    conv_scalar(coeffs, taps, samples[0] + j, out[0] + j, n - j);
+    conv_scalar(coeffs, taps, samples[1] + j, out[1] + j, n - j);
+}
+
+/**
+ * AVX-512 block convolution of two channels computing
+ * 32 outputs of each per pass over the coefficients.
+ *
+ * @param coeffs the reversed coefficients
+ * @param taps the number of coefficients
+ * @param samples the samples of the two channels, of length
+ * n + taps - 1
+ * @param out the n outputs of the two channels
+ * @param n the number of outputs per channel
+ */
+__attribute__((target("avx512f")))
+static void conv_pair_avx512(const double *coeffs, size_t taps,
+                             const double *const *samples, double *const *out, size_t n) {
+    size_t j = 0;
+    for (; j + 32 <= n; j += 32) {
+        __m512d x_acc0 = _mm512_setzero_pd();
+        __m512d x_acc1 = _mm512_setzero_pd();
+        __m512d x_acc2 = _mm512_setzero_pd();
+        __m512d x_acc3 = _mm512_setzero_pd();
+        __m512d y_acc0 = _mm512_setzero_pd();
+        __m512d y_acc1 = _mm512_setzero_pd();
+        __m512d y_acc2 = _mm512_setzero_pd();
+        __m512d y_acc3 = _mm512_setzero_pd();
+
+        const double *x = samples[0] + j;
+        const double *y = samples[1] + j;
+        for (size_t k = 0; k < taps; ++k) {
+            __m512d c = _mm512_set1_pd(coeffs[k]);
+            x_acc0 = _mm512_fmadd_pd(c, _mm512_loadu_pd(x + k), x_acc0);
+            x_acc1 = _mm512_fmadd_pd(c, _mm512_loadu_pd(x + k + 8), x_acc1);
+            x_acc2 = _mm512_fmadd_pd(c, _mm512_loadu_pd(x + k + 16), x_acc2);
+            x_acc3 = _mm512_fmadd_pd(c, _mm512_loadu_pd(x + k + 24), x_acc3);
+            y_acc0 = _mm512_fmadd_pd(c, _mm512_loadu_pd(y + k), y_acc0);
+            y_acc1 = _mm512_fmadd_pd(c, _mm512_loadu_pd(y + k + 8), y_acc1);
+            y_acc2 = _mm512_fmadd_pd(c, _mm512_loadu_pd(y + k + 16), y_acc2);
+            y_acc3 = _mm512_fmadd_pd(c, _mm512_loadu_pd(y + k + 24), y_acc3);
+        }
+
+        _mm512_storeu_pd(out[0] + j, x_acc0);
+        _mm512_storeu_pd(out[0] + j + 8, x_acc1);
+        _mm512_storeu_pd(out[0] + j + 16, x_acc2);
+        _mm512_storeu_pd(out[0] + j + 24, x_acc3);
+        _mm512_storeu_pd(out[1] + j, y_acc0);
+        _mm512_storeu_pd(out[1] + j + 8, y_acc1);
+        _mm512_storeu_pd(out[1] + j + 16, y_acc2);
+        _mm512_storeu_pd(out[1] + j + 24, y_acc3);
+    }
+
+    conv_avx2(coeffs, taps, samples[0] + j, out[0] + j, n - j);
+    conv_avx2(coeffs, taps, samples[1] + j, out[1] + j, n - j);
+}
+
+/**
+ * AVX2 linear-phase block convolution of two channels
+ * computing 16 outputs of each per pass over the
+ * coefficients.
+ *
+ * @tparam anti whether the filter is antisymmetric
+ * @param half_coeffs the first (taps + 1) / 2 reversed
+ * coefficients
+ * @param taps the length of the filter
+ * @param samples the samples of the two channels, of length
+ * n + taps - 1
+ * @param out the n outputs of the two channels
+ * @param n the number of outputs per channel
+ */
+template<bool anti>
+__attribute__((target("avx2,fma")))
+static void sym_conv_pair_avx2(const double *half_coeffs, size_t taps,
+                               const double *const *samples, double *const *out, size_t n) {
+    size_t half = taps / 2;
+    size_t j = 0;
+    for (; j + 16 <= n; j += 16) {
+        __m256d x_acc0 = _mm256_setzero_pd();
+        __m256d x_acc1 = _mm256_setzero_pd();
+        __m256d x_acc2 = _mm256_setzero_pd();
+        __m256d x_acc3 = _mm256_setzero_pd();
+        __m256d y_acc0 = _mm256_setzero_pd();
+        __m256d y_acc1 = _mm256_setzero_pd();
+        __m256d y_acc2 = _mm256_setzero_pd();
+        __m256d y_acc3 = _mm256_setzero_pd();
+
+        const double *x = samples[0] + j;
+        const double *y = samples[1] + j;
+        const double *x_m = x + taps - 1;
+        const double *y_m = y + taps - 1;
+        for (size_t k = 0; k < half; ++k) {
+            __m256d c = _mm256_broadcast_sd(half_coeffs + k);
+            x_acc0 = _mm256_fmadd_pd(c, mirror_combine<anti>(_mm256_loadu_pd(x + k), _mm256_loadu_pd(x_m - k)), x_acc0);
+            x_acc1 = _mm256_fmadd_pd(c, mirror_combine<anti>(_mm256_loadu_pd(x + k + 4), _mm256_loadu_pd(x_m - k + 4)), x_acc1);
+            x_acc2 = _mm256_fmadd_pd(c, mirror_combine<anti>(_mm256_loadu_pd(x + k + 8), _mm256_loadu_pd(x_m - k + 8)), x_acc2);
+            x_acc3 = _mm256_fmadd_pd(c, mirror_combine<anti>(_mm256_loadu_pd(x + k + 12), _mm256_loadu_pd(x_m - k + 12)), x_acc3);
+            y_acc0 = _mm256_fmadd_pd(c, mirror_combine<anti>(_mm256_loadu_pd(y + k), _mm256_loadu_pd(y_m - k)), y_acc0);
+            y_acc1 = _mm256_fmadd_pd(c, mirror_combine<anti>(_mm256_loadu_pd(y + k + 4), _mm256_loadu_pd(y_m - k + 4)), y_acc1);
+            y_acc2 = _mm256_fmadd_pd(c, mirror_combine<anti>(_mm256_loadu_pd(y + k + 8), _mm256_loadu_pd(y_m - k + 8)), y_acc2);
+            y_acc3 = _mm256_fmadd_pd(c, mirror_combine<anti>(_mm256_loadu_pd(y + k + 12), _mm256_loadu_pd(y_m - k + 12)), y_acc3);
+        }
+        if (taps % 2 != 0) {
+            __m256d c = _mm256_broadcast_sd(half_coeffs + half);
+            x_acc0 = _mm256_fmadd_pd(c, _mm256_loadu_pd(x + half), x_acc0);
+            x_acc1 = _mm256_fmadd_pd(c, _mm256_loadu_pd(x + half + 4), x_acc1);
+            x_acc2 = _mm256_fmadd_pd(c, _mm256_loadu_pd(x + half + 8), x_acc2);
+            x_acc3 = _mm256_fmadd_pd(c, _mm256_loadu_pd(x + half + 12), x_acc3);
+            y_acc0 = _mm256_fmadd_pd(c, _mm256_loadu_pd(y + half), y_acc0);
+            y_acc1 = _mm256_fmadd_pd(c, _mm256_loadu_pd(y + half + 4), y_acc1);
+            y_acc2 = _mm256_fmadd_pd(c, _mm256_loadu_pd(y + half + 8), y_acc2);
+            y_acc3 = _mm256_fmadd_pd(c, _mm256_loadu_pd(y + half + 12), y_acc3);
+        }
+
+        _mm256_storeu_pd(out[0] + j, x_acc0);
+        _mm256_storeu_pd(out[0] + j + 4, x_acc1);
+        _mm256_storeu_pd(out[0] + j + 8, x_acc2);
+        _mm256_storeu_pd(out[0] + j + 12, x_acc3);
+        _mm256_storeu_pd(out[1] + j, y_acc0);
+        _mm256_storeu_pd(out[1] + j + 4, y_acc1);
+        _mm256_storeu_pd(out[1] + j + 8, y_acc2);
+        _mm256_storeu_pd(out[1] + j + 12, y_acc3);
+    }
+
+    sym_conv_scalar<anti>(half_coeffs, taps, samples[0] + j, out[0] + j, n - j);
+    sym_conv_scalar<anti>(half_coeffs, taps, samples[1] + j, out[1] + j, n - j);
+}
+
+/**
+ * AVX-512 linear-phase block convolution of two channels
+ * computing 32 outputs of each per pass over the
+ * coefficients.
+ *
+ * @tparam anti whether the filter is antisymmetric
+ * @param half_coeffs the first (taps + 1) / 2 reversed
+ * coefficients
+ * @param taps the length of the filter
+ * @param samples the samples of the two channels, of length
+ * n + taps - 1
+ * @param out the n outputs of the two channels
+ * @param n the number of outputs per channel
+ */
+template<bool anti>
+__attribute__((target("avx512f")))
+static void sym_conv_pair_avx512(const double *half_coeffs, size_t taps,
+                                 const double *const *samples, double *const *out, size_t n) {
+    size_t half = taps / 2;
+    size_t j = 0;
+    for (; j + 32 <= n; j += 32) {
+        __m512d x_acc0 = _mm512_setzero_pd();
+        __m512d x_acc1 = _mm512_setzero_pd();
+        __m512d x_acc2 = _mm512_setzero_pd();
+        __m512d x_acc3 = _mm512_setzero_pd();
+        __m512d y_acc0 = _mm512_setzero_pd();
+        __m512d y_acc1 = _mm512_setzero_pd();
+        __m512d y_acc2 = _mm512_setzero_pd();
+        __m512d y_acc3 = _mm512_setzero_pd();
+
+        const double *x = samples[0] + j;
+        const double *y = samples[1] + j;
+        const double *x_m = x + taps - 1;
+        const double *y_m = y + taps - 1;
+        for (size_t k = 0; k < half; ++k) {
+            __m512d c = _mm512_set1_pd(half_coeffs[k]);
+            x_acc0 = _mm512_fmadd_pd(c, mirror_combine<anti>(_mm512_loadu_pd(x + k), _mm512_loadu_pd(x_m - k)), x_acc0);
+            x_acc1 = _mm512_fmadd_pd(c, mirror_combine<anti>(_mm512_loadu_pd(x + k + 8), _mm512_loadu_pd(x_m - k + 8)), x_acc1);
+            x_acc2 = _mm512_fmadd_pd(c, mirror_combine<anti>(_mm512_loadu_pd(x + k + 16), _mm512_loadu_pd(x_m - k + 16)), x_acc2);
+            x_acc3 = _mm512_fmadd_pd(c, mirror_combine<anti>(_mm512_loadu_pd(x + k + 24), _mm512_loadu_pd(x_m - k + 24)), x_acc3);
+            y_acc0 = _mm512_fmadd_pd(c, mirror_combine<anti>(_mm512_loadu_pd(y + k), _mm512_loadu_pd(y_m - k)), y_acc0);
+            y_acc1 = _mm512_fmadd_pd(c, mirror_combine<anti>(_mm512_loadu_pd(y + k + 8), _mm512_loadu_pd(y_m - k + 8)), y_acc1);
+            y_acc2 = _mm512_fmadd_pd(c, mirror_combine<anti>(_mm512_loadu_pd(y + k + 16), _mm512_loadu_pd(y_m - k + 16)), y_acc2);
+            y_acc3 = _mm512_fmadd_pd(c, mirror_combine<anti>(_mm512_loadu_pd(y + k + 24), _mm512_loadu_pd(y_m - k + 24)), y_acc3);
+        }
+        if (taps % 2 != 0) {
+            __m512d c = _mm512_set1_pd(half_coeffs[half]);
+            x_acc0 = _mm512_fmadd_pd(c, _mm512_loadu_pd(x + half), x_acc0);
+            x_acc1 = _mm512_fmadd_pd(c, _mm512_loadu_pd(x + half + 8), x_acc1);
+            x_acc2 = _mm512_fmadd_pd(c, _mm512_loadu_pd(x + half + 16), x_acc2);
+            x_acc3 = _mm512_fmadd_pd(c, _mm512_loadu_pd(x + half + 24), x_acc3);
+            y_acc0 = _mm512_fmadd_pd(c, _mm512_loadu_pd(y + half), y_acc0);
+            y_acc1 = _mm512_fmadd_pd(c, _mm512_loadu_pd(y + half + 8), y_acc1);
+            y_acc2 = _mm512_fmadd_pd(c, _mm512_loadu_pd(y + half + 16), y_acc2);
+            y_acc3 = _mm512_fmadd_pd(c, _mm512_loadu_pd(y + half + 24), y_acc3);
+        }
+
+        _mm512_storeu_pd(out[0] + j, x_acc0);
+        _mm512_storeu_pd(out[0] + j + 8, x_acc1);
+        _mm512_storeu_pd(out[0] + j + 16, x_acc2);
+        _mm512_storeu_pd(out[0] + j + 24, x_acc3);
+        _mm512_storeu_pd(out[1] + j, y_acc0);
+        _mm512_storeu_pd(out[1] + j + 8, y_acc1);
+        _mm512_storeu_pd(out[1] + j + 16, y_acc2);
+        _mm512_storeu_pd(out[1] + j + 24, y_acc3);
+    }
+
+    sym_conv_avx2<anti>(half_coeffs, taps, samples[0] + j, out[0] + j, n - j);
+    sym_conv_avx2<anti>(half_coeffs, taps, samples[1] + j, out[1] + j, n - j);
+}
+
+#endif // TELEM_FILTER_X86
+
+simd_isa fir_kernels::detect() {
+#ifdef TELEM_FILTER_X86
+    __builtin_cpu_init();
+    // The AVX-512 kernels finish their tails with AVX2
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return __builtin_cpu_supports("avx512f") ? simd_isa::avx512 : simd_isa::avx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return simd_isa::sse2;
+    }
+#endif
+
+    return simd_isa::scalar;
+}
+
+bool fir_kernels::supported(simd_isa isa) {
+    return static_cast<int>(isa) <= static_cast<int>(detect());
+}
+
+fir_dot_kernel fir_kernels::dot(simd_isa isa) {
+    switch (isa) {
+#ifdef TELEM_FILTER_X86
+        case simd_isa::sse2:
+            return dot_sse2;
+        case simd_isa::avx2:
+            return dot_avx2;
+        case simd_isa::avx512:
+            return dot_avx512;
+#endif
+        default:
+            return dot_scalar;
+    }
+}
+
+fir_dot_kernel fir_kernels::dot() {
+    static const fir_dot_kernel best = dot(detect());
+    return best;
+}
+
+fir_conv_kernel fir_kernels::conv(simd_isa isa) {
+    switch (isa) {
+#ifdef TELEM_FILTER_X86
+        case simd_isa::sse2:
+            return conv_sse2;
+        case simd_isa::avx2:
+            return conv_avx2;
+        case simd_isa::avx512:
+            return conv_avx512;
+#endif
+        default:
+            return conv_scalar;
+    }
+}
+
+fir_conv_kernel fir_kernels::conv() {
+    static const fir_conv_kernel best = conv(detect());
+    return best;
+}
+
+fir_sym_dot_kernel fir_kernels::sym_dot(simd_isa isa, bool antisymmetric) {
+    switch (isa) {
+#ifdef TELEM_FILTER_X86
+        case simd_isa::sse2:
+            return antisymmetric ? sym_dot_sse2<true> : sym_dot_sse2<false>;
+        case simd_isa::avx2:
+            return antisymmetric ? sym_dot_avx2<true> : sym_dot_avx2<false>;
+        case simd_isa::avx512:
+            return antisymmetric ? sym_dot_avx512<true> : sym_dot_avx512<false>;
+#endif
+        default:
+            return antisymmetric ? sym_dot_scalar<true> : sym_dot_scalar<false>;
+    }
+}
+
+fir_sym_conv_kernel fir_kernels::sym_conv(simd_isa isa, bool antisymmetric) {
+    switch (isa) {
+#ifdef TELEM_FILTER_X86
+        case simd_isa::sse2:
+            return antisymmetric ? sym_conv_sse2<true> : sym_conv_sse2<false>;
+        case simd_isa::avx2:
+            return antisymmetric ? sym_conv_avx2<true> : sym_conv_avx2<false>;
+        case simd_isa::avx512:
+            return antisymmetric ? sym_conv_avx512<true> : sym_conv_avx512<false>;
+#endif
+        default:
+            return antisymmetric ? sym_conv_scalar<true> : sym_conv_scalar<false>;
+    }
+}
+
+fir_conv_channels_kernel fir_kernels::conv_channels(simd_isa isa) {
+    switch (isa) {
+#ifdef TELEM_FILTER_X86
+        case simd_isa::sse2:
+            return conv_each<conv_sse2>;
+        case simd_isa::avx2:
+            return conv_pairs<conv_pair_avx2, conv_avx2>;
+        case simd_isa::avx512:
+            return conv_pairs<conv_pair_avx512, conv_avx512>;
+#endif
+        default:
+            return conv_each<conv_scalar>;
+    }
+}
+
+fir_sym_conv_channels_kernel fir_kernels::sym_conv_channels(simd_isa isa, bool antisymmetric) {
+    switch (isa) {
+#ifdef TELEM_FILTER_X86
+        case simd_isa::sse2:
+            return antisymmetric ? conv_each<sym_conv_sse2<true>> : conv_each<sym_conv_sse2<false>>;
+        case simd_isa::avx2:
+            return antisymmetric ? conv_pairs<sym_conv_pair_avx2<true>, sym_conv_avx2<true>>
+                                 : conv_pairs<sym_conv_pair_avx2<false>, sym_conv_avx2<false>>;
+        case simd_isa::avx512:
+            return antisymmetric ? conv_pairs<sym_conv_pair_avx512<true>, sym_conv_avx512<true>>
+                                 : conv_pairs<sym_conv_pair_avx512<false>, sym_conv_avx512<false>>;
+#endif
+        default:
+            return antisymmetric ? conv_each<sym_conv_scalar<true>> : conv_each<sym_conv_scalar<false>>;
+    }
+}
+
+const char *fir_kernels::name(simd_isa isa) {
+    switch (isa) {
+        case simd_isa::sse2:
+            return "SSE2";
+        case simd_isa::avx2:
+            return "AVX2";
+        case simd_isa::avx512:
+            return "AVX-512";
+        default:
+            return "scalar";
+    }
+}
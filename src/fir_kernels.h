@@ -0,0 +1,233 @@
+/**
+ * @file
+ */
+
+#ifndef TELEM_FILTER_FIR_KERNELS_H
+#define TELEM_FILTER_FIR_KERNELS_H
+
+#include <cstddef>
+
+#if defined(__x86_64__) || defined(__i386__)
+/**
+ * Defined if the x86 SIMD kernels are compiled in.
+ */
+#define TELEM_FILTER_X86 1
+#endif
+
+/**
+ * @brief The instruction set extensions for which FIR
+ * kernels are provided.
+ */
+enum class simd_isa {
+    /**
+     * Portable scalar code, which sums the taps in order.
+     */
+    scalar,
+    /**
+     * x86 SSE2, with 2 doubles per vector.
+     */
+    sse2,
+    /**
+     * x86 AVX2 with FMA, with 4 doubles per vector.
+     */
+    avx2,
+    /**
+     * x86 AVX-512F, with 8 doubles per vector.
+     */
+    avx512
+};
+
+/**
+ * A kernel that computes the dot product of n filter
+ * coefficients and n contiguous samples.
+ */
+using fir_dot_kernel = double (*)(const double *coeffs, const double *samples, size_t n);
+
+/**
+ * A kernel that convolves a block of samples with taps
+ * coefficients, such that out[j] is the dot product of the
+ * coefficients with samples[j] through
+ * samples[j + taps - 1] for each of the n outputs.
+ *
+ * The coefficients are in reverse tap order, i.e. the first
+ * coefficient applies to the oldest sample of each window.
+ */
+using fir_conv_kernel = void (*)(const double *coeffs, size_t taps,
+                                 const double *samples, double *out, size_t n);
+
+/**
+ * A kernel that computes the output of a linear-phase FIR
+ * filter from taps contiguous samples using only the first
+ * (taps + 1) / 2 coefficients, by adding (or, for
+ * antisymmetric filters, subtracting) mirrored samples
+ * before multiplying:
+ *
+ *   sum(c[k] * (samples[k] +/- samples[taps - 1 - k]))
+ *
+ * over k < taps / 2, plus c[taps / 2] * samples[taps / 2]
+ * if taps is odd.
+ */
+using fir_sym_dot_kernel = double (*)(const double *half_coeffs, const double *samples, size_t taps);
+
+/**
+ * A kernel that convolves a block of samples with a
+ * linear-phase FIR filter, such that out[j] is the result
+ * of the corresponding fir_sym_dot_kernel over samples[j]
+ * through samples[j + taps - 1] for each of the n outputs.
+ *
+ * The coefficients are in reverse tap order, as for
+ * fir_conv_kernel.
+ */
+using fir_sym_conv_kernel = void (*)(const double *half_coeffs, size_t taps,
+                                     const double *samples, double *out, size_t n);
+
+/**
+ * A kernel that convolves blocks of several channels of
+ * samples with the same taps coefficients, such that
+ * out[c][j] is the result of the corresponding
+ * fir_conv_kernel over samples[c][j] through
+ * samples[c][j + taps - 1] for each of the n outputs of
+ * each of the channels.
+ *
+ * The channels are read and written in place, one array
+ * each, and each coefficient is broadcast once for a group
+ * of channels rather than once per channel.
+ */
+using fir_conv_channels_kernel = void (*)(const double *coeffs, size_t taps,
+                                          const double *const *samples, double *const *out,
+                                          size_t channels, size_t n);
+
+/**
+ * A kernel that convolves blocks of several channels of
+ * samples with the same linear-phase FIR filter, as
+ * fir_sym_conv_kernel does for each channel and
+ * fir_conv_channels_kernel does for unfolded coefficients.
+ */
+using fir_sym_conv_channels_kernel = void (*)(const double *half_coeffs, size_t taps,
+                                              const double *const *samples, double *const *out,
+                                              size_t channels, size_t n);
+
+/**
+ * @brief Provides the FIR tap kernels, selected at runtime
+ * according to the capabilities of the CPU.
+ *
+ * The vectorized kernels sum the products in a different
+ * order than the scalar reference, so their results may
+ * differ from it by rounding error.
+ */
+class fir_kernels {
+public:
+    /**
+     * Determines the widest instruction set supported by
+     * both this build and the running CPU.
+     *
+     * @return the best available instruction set
+     */
+    static simd_isa detect();
+
+    /**
+     * Determines whether kernels for the given instruction
+     * set can run on this CPU.
+     *
+     * @param isa the instruction set
+     * @return true if the kernels are usable
+     */
+    static bool supported(simd_isa isa);
+
+    /**
+     * Obtains the dot product kernel for the given
+     * instruction set, which must be supported().
+     *
+     * @param isa the instruction set
+     * @return the kernel
+     */
+    static fir_dot_kernel dot(simd_isa isa);
+
+    /**
+     * Obtains the dot product kernel for the best
+     * instruction set available, detecting it on first use.
+     *
+     * @return the kernel
+     */
+    static fir_dot_kernel dot();
+
+    /**
+     * Obtains the block convolution kernel for the given
+     * instruction set, which must be supported().
+     *
+     * The vectorized kernels compute several adjacent
+     * outputs per instruction, so each coefficient is loaded
+     * once per group of outputs rather than once per output.
+     *
+     * @param isa the instruction set
+     * @return the kernel
+     */
+    static fir_conv_kernel conv(simd_isa isa);
+
+    /**
+     * Obtains the block convolution kernel for the best
+     * instruction set available, detecting it on first use.
+     *
+     * @return the kernel
+     */
+    static fir_conv_kernel conv();
+
+    /**
+     * Obtains the linear-phase dot product kernel for the
+     * given instruction set, which must be supported().
+     *
+     * @param isa the instruction set
+     * @param antisymmetric true to subtract rather than add
+     * the mirrored samples
+     * @return the kernel
+     */
+    static fir_sym_dot_kernel sym_dot(simd_isa isa, bool antisymmetric);
+
+    /**
+     * Obtains the linear-phase block convolution kernel for
+     * the given instruction set, which must be supported().
+     *
+     * @param isa the instruction set
+     * @param antisymmetric true to subtract rather than add
+     * the mirrored samples
+     * @return the kernel
+     */
+    static fir_sym_conv_kernel sym_conv(simd_isa isa, bool antisymmetric);
+
+    /**
+     * Obtains the multi-channel block convolution kernel for
+     * the given instruction set, which must be supported().
+     *
+     * The AVX2 and AVX-512 kernels convolve two channels per
+     * pass over the coefficients, so each coefficient is
+     * loaded and broadcast once per pair of channels. SSE2
+     * has too few registers to hold the accumulators of two
+     * channels, so its kernels convolve one at a time.
+     *
+     * @param isa the instruction set
+     * @return the kernel
+     */
+    static fir_conv_channels_kernel conv_channels(simd_isa isa);
+
+    /**
+     * Obtains the multi-channel linear-phase block
+     * convolution kernel for the given instruction set,
+     * which must be supported().
+     *
+     * @param isa the instruction set
+     * @param antisymmetric true to subtract rather than add
+     * the mirrored samples
+     * @return the kernel
+     */
+    static fir_sym_conv_channels_kernel sym_conv_channels(simd_isa isa, bool antisymmetric);
+
+    /**
+     * Obtains a human-readable name for the instruction set.
+     *
+     * @param isa the instruction set
+     * @return the name
+     */
+    static const char *name(simd_isa isa);
+};
+
+#endif // TELEM_FILTER_FIR_KERNELS_H
@@ -0,0 +1,471 @@
+/**
+ * @file
+ */
+
+#ifndef TELEM_FILTER_FIXED_FIR_H
+#define TELEM_FILTER_FIXED_FIR_H
+
+#include <algorithm>
+#include <array>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "array_view.h"
+#include "digital_filter.h"
+#include "fir_kernels.h"
+#include "signal_filter.h"
+
+/**
+ * @brief An FIR filter whose coefficients are fixed at
+ * compile time.
+ *
+ * The coefficients are a constexpr std::array with static
+ * storage duration, passed by reference as the template
+ * argument. The tap count and every coefficient are then
+ * known to the compiler, which unrolls the sum over the
+ * taps completely, encodes the coefficients as constants
+ * and folds mirrored taps of linear-phase filters together.
+ *
+ * Blocks are filtered several outputs at a time, which the
+ * compiler vectorizes across the outputs. Like
+ * digital_filter, the widest instruction set the CPU
+ * supports is used unless another is selected with
+ * set_isa().
+ *
+ * The filter produces the same output as a digital_filter
+ * with the same coefficients, up to rounding error, and may
+ * be used in its place through the signal_filter interface.
+ *
+ * @tparam coeffs the numerator coefficients
+ */
+template<const auto &coeffs>
+class fixed_fir : public signal_filter {
+public:
+    /**
+     * The type of the coefficient array.
+     */
+    using coeffs_type = std::remove_cv_t<std::remove_reference_t<decltype(coeffs)>>;
+
+    /**
+     * The number of taps.
+     */
+    static constexpr size_t taps = std::tuple_size<coeffs_type>::value;
+
+    static_assert(taps > 0, "FIR filter requires coefficients");
+
+private:
+    /**
+     * Determines the symmetry of the coefficients at compile
+     * time, in the manner of
+     * digital_filter::detect_symmetry().
+     *
+     * @return the symmetry of the coefficients
+     */
+    static constexpr fir_symmetry find_symmetry();
+
+public:
+    /**
+     * The symmetry of the coefficients.
+     */
+    static constexpr fir_symmetry symmetry = find_symmetry();
+
+private:
+    /**
+     * The signature of the functions filtering a block of
+     * samples.
+     *
+     * @param samples the last taps - 1 inputs followed by
+     * the n samples of the block
+     * @param out the n outputs
+     * @param n the number of outputs
+     */
+    using block_kernel = void (*)(const double *samples, double *out, size_t n);
+
+    /**
+     * The number of products summed per output, which is
+     * halved by folding mirrored taps together if the filter
+     * is symmetric or antisymmetric.
+     */
+    static constexpr size_t terms = symmetry == fir_symmetry::none ? taps : taps / 2;
+
+    /**
+     * The doubled buffer of prior input samples, oldest
+     * first, whose (pos + 1)-th through (pos + taps - 1)-th
+     * elements are the most recent taps - 1 inputs.
+     */
+    std::array<double, 2 * taps> hist{};
+    /**
+     * The position at which the next input is recorded in
+     * hist.
+     */
+    size_t pos{0};
+    /**
+     * Scratch buffer holding the recent input history
+     * followed by the block being filtered. It only grows,
+     * so steady streaming does not allocate.
+     */
+    std::vector<double> block_buf;
+
+    /**
+     * The function used to filter whole blocks.
+     */
+    block_kernel conv{select_kernel(fir_kernels::detect())};
+
+    /**
+     * Computes the product of one coefficient, or of one
+     * pair of mirrored coefficients if the filter is
+     * symmetric or antisymmetric, with its inputs.
+     *
+     * @tparam k the index of the coefficient
+     * @param x the taps inputs of the output, oldest first
+     * @return the product
+     */
+    template<size_t k>
+    __attribute__((always_inline)) static double term(const double *x);
+
+    /**
+     * Adds the product of one coefficient to the sums of
+     * consecutive outputs.
+     *
+     * @tparam k the index of the coefficient
+     * @tparam width the number of outputs
+     * @tparam j the indices of the outputs
+     * @param acc the sums of the outputs
+     * @param x the inputs of the outputs, oldest first,
+     * starting with the taps inputs of the first output
+     */
+    template<size_t k, size_t width, size_t... j>
+    __attribute__((always_inline)) static void add_term(std::array<double, width> &acc,
+                                                        const double *x,
+                                                        std::index_sequence<j...>);
+
+    /**
+     * Sums the coefficient products of consecutive outputs.
+     * Every output sums its taps in order, however many
+     * outputs are summed together.
+     *
+     * The sums are unrolled completely, so the callers that
+     * compile them for wider instruction sets must inline
+     * them.
+     *
+     * @tparam width the number of outputs
+     * @tparam k the indices of the coefficients
+     * @param x the inputs of the outputs, oldest first,
+     * starting with the taps inputs of the first output
+     * @param out the outputs
+     */
+    template<size_t width, size_t... k>
+    __attribute__((always_inline)) static void sum_terms(const double *x,
+                                                         double *out,
+                                                         std::index_sequence<k...>);
+
+    /**
+     * Sums the coefficient products of a single output into
+     * four partial sums, which shortens the dependency chain
+     * of the additions.
+     *
+     * @tparam k the indices of the coefficients
+     * @param x the taps inputs of the output, oldest first
+     * @return the output sample
+     */
+    template<size_t... k>
+    static double sum_sample(const double *x, std::index_sequence<k...>);
+
+    /**
+     * Filters a block several outputs at a time.
+     *
+     * @tparam width the number of outputs summed together
+     * @param samples the last taps - 1 inputs followed by
+     * the n samples of the block
+     * @param out the n outputs
+     * @param n the number of outputs
+     */
+    template<size_t width>
+    static void convolve(const double *samples, double *out, size_t n);
+
+#ifdef TELEM_FILTER_X86
+    /**
+     * Filters a block 16 outputs at a time using AVX2.
+     *
+     * @param samples the last taps - 1 inputs followed by
+     * the n samples of the block
+     * @param out the n outputs
+     * @param n the number of outputs
+     */
+    __attribute__((target("avx2,fma"))) static void convolve_avx2(const double *samples, double *out, size_t n);
+
+    /**
+     * Filters a block 32 outputs at a time using AVX-512.
+     *
+     * @param samples the last taps - 1 inputs followed by
+     * the n samples of the block
+     * @param out the n outputs
+     * @param n the number of outputs
+     */
+    __attribute__((target("avx512f"))) static void convolve_avx512(const double *samples, double *out, size_t n);
+#endif
+
+    /**
+     * Selects the function used to filter whole blocks with
+     * the given instruction set.
+     *
+     * @param isa the instruction set
+     * @return the block function
+     */
+    static block_kernel select_kernel(simd_isa isa);
+
+    /**
+     * Records the next input sample in the input history.
+     *
+     * @param x the input sample
+     */
+    void push_input(double x);
+
+public:
+    std::vector<double> transform(array_view<const double> signal) const override;
+
+    /**
+     * Performs the transformation of transform() on each
+     * channel of a multi-channel signal.
+     *
+     * The coefficients are constants of the block
+     * functions, so each channel is convolved in place,
+     * without the copies into the history and block buffer
+     * made by transform().
+     *
+     * @param signals the channels to transform, which must
+     * have the same length
+     * @return the resulting channels, in the same order
+     * @throws std::invalid_argument if the channels differ
+     * in length
+     */
+    std::vector<std::vector<double>> transform_channels(
+            const std::vector<array_view<const double>> &signals) const override;
+
+    double process(double x) override;
+
+    void process_block(array_view<const double> in, array_view<double> out) override;
+
+    /**
+     * Selects the instruction set used to filter blocks,
+     * e.g. to obtain the scalar reference result, which
+     * filters one output at a time.
+     *
+     * @param isa the instruction set, which must be
+     * supported by the CPU
+     */
+    void set_isa(simd_isa isa);
+
+    void reset() override;
+};
+
+template<const auto &coeffs>
+constexpr fir_symmetry fixed_fir<coeffs>::find_symmetry() {
+    if (taps < 2) {
+        return fir_symmetry::none;
+    }
+
+    bool symmetric = true;
+    bool antisymmetric = true;
+    for (size_t k = 0; k < taps; ++k) {
+        symmetric = symmetric && coeffs[k] == coeffs[taps - 1 - k];
+        antisymmetric = antisymmetric && coeffs[k] == -coeffs[taps - 1 - k];
+    }
+
+    if (symmetric) {
+        return fir_symmetry::symmetric;
+    }
+    return antisymmetric ? fir_symmetry::antisymmetric : fir_symmetry::none;
+}
+
+template<const auto &coeffs>
+template<size_t k>
+inline double fixed_fir<coeffs>::term(const double *x) {
+    // Coefficient k multiplies the input k samples before the
+    // newest, x[taps - 1 - k]
+    if constexpr (symmetry == fir_symmetry::symmetric) {
+        return coeffs[k] * (x[taps - 1 - k] + x[k]);
+    } else if constexpr (symmetry == fir_symmetry::antisymmetric) {
+        return coeffs[k] * (x[taps - 1 - k] - x[k]);
+    } else {
+        return coeffs[k] * x[taps - 1 - k];
+    }
+}
+
+template<const auto &coeffs>
+template<size_t k, size_t width, size_t... j>
+inline void fixed_fir<coeffs>::add_term(std::array<double, width> &acc, const double *x, std::index_sequence<j...>) {
+    ((acc[j] += term<k>(x + j)), ...);
+}
+
+template<const auto &coeffs>
+template<size_t width, size_t... k>
+inline void fixed_fir<coeffs>::sum_terms(const double *x, double *out, std::index_sequence<k...>) {
+    std::array<double, width> acc{};
+    (add_term<k>(acc, x, std::make_index_sequence<width>{}), ...);
+
+    // The middle tap of an antisymmetric filter is zero
+    if constexpr (symmetry == fir_symmetry::symmetric && taps % 2 != 0) {
+        for (size_t j = 0; j < width; ++j) {
+            acc[j] += coeffs[taps / 2] * x[j + taps / 2];
+        }
+    }
+
+    std::copy(acc.begin(), acc.end(), out);
+}
+
+template<const auto &coeffs>
+template<size_t... k>
+double fixed_fir<coeffs>::sum_sample(const double *x, std::index_sequence<k...>) {
+    std::array<double, 4> acc{};
+    ((acc[k % 4] += term<k>(x)), ...);
+
+    double sum = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+    if constexpr (symmetry == fir_symmetry::symmetric && taps % 2 != 0) {
+        sum += coeffs[taps / 2] * x[taps / 2];
+    }
+
+    return sum;
+}
+
+template<const auto &coeffs>
+template<size_t width>
+void fixed_fir<coeffs>::convolve(const double *samples, double *out, size_t n) {
+    size_t i = 0;
+    for (; i + width <= n; i += width) {
+        sum_terms<width>(samples + i, out + i, std::make_index_sequence<terms>{});
+    }
+    for (; i < n; ++i) {
+        sum_terms<1>(samples + i, out + i, std::make_index_sequence<terms>{});
+    }
+}
+
+#ifdef TELEM_FILTER_X86
+template<const auto &coeffs>
+void fixed_fir<coeffs>::convolve_avx2(const double *samples, double *out, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        sum_terms<16>(samples + i, out + i, std::make_index_sequence<terms>{});
+    }
+    for (; i < n; ++i) {
+        sum_terms<1>(samples + i, out + i, std::make_index_sequence<terms>{});
+    }
+}
+
+template<const auto &coeffs>
+void fixed_fir<coeffs>::convolve_avx512(const double *samples, double *out, size_t n) {
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        sum_terms<32>(samples + i, out + i, std::make_index_sequence<terms>{});
+    }
+    for (; i < n; ++i) {
+        sum_terms<1>(samples + i, out + i, std::make_index_sequence<terms>{});
+    }
+}
+#endif
+
+template<const auto &coeffs>
+typename fixed_fir<coeffs>::block_kernel fixed_fir<coeffs>::select_kernel(simd_isa isa) {
+    switch (isa) {
+#ifdef TELEM_FILTER_X86
+        case simd_isa::avx2:
+            return convolve_avx2;
+        case simd_isa::avx512:
+            return convolve_avx512;
+#endif
+        case simd_isa::scalar:
+            return convolve<1>;
+        default:
+            return convolve<8>;
+    }
+}
+
+template<const auto &coeffs>
+void fixed_fir<coeffs>::push_input(double x) {
+    hist[pos] = x;
+    hist[pos + taps] = x;
+    pos = pos + 1 == taps ? 0 : pos + 1;
+}
+
+template<const auto &coeffs>
+std::vector<double> fixed_fir<coeffs>::transform(array_view<const double> signal) const {
+    std::vector<double> result(signal.size());
+
+    fixed_fir stream{*this};
+    stream.reset();
+    stream.process_block(signal, result);
+
+    return result;
+}
+
+template<const auto &coeffs>
+std::vector<std::vector<double>> fixed_fir<coeffs>::transform_channels(
+        const std::vector<array_view<const double>> &signals) const {
+    size_t len = channel_length(signals);
+    size_t hist_len = taps - 1;
+    if (len < hist_len) {
+        return signal_filter::transform_channels(signals);
+    }
+
+    // The first taps - 1 outputs reach back before the
+    // start, so they are convolved from a zero-padded copy
+    // of it
+    std::vector<double> head(2 * hist_len, 0);
+
+    std::vector<std::vector<double>> results;
+    results.reserve(signals.size());
+    for (const array_view<const double> &signal : signals) {
+        std::vector<double> result(len);
+        std::copy(signal.begin(), signal.begin() + hist_len, head.begin() + hist_len);
+        conv(head.data(), result.data(), hist_len);
+
+        // The remaining outputs are convolved from the
+        // channel in place
+        conv(signal.data(), result.data() + hist_len, len - hist_len);
+        results.push_back(std::move(result));
+    }
+
+    return results;
+}
+
+template<const auto &coeffs>
+double fixed_fir<coeffs>::process(double x) {
+    size_t newest = pos;
+    push_input(x);
+
+    // The newest input completes the window of the last taps
+    // inputs, oldest first
+    return sum_sample(hist.data() + newest + 1, std::make_index_sequence<terms>{});
+}
+
+template<const auto &coeffs>
+void fixed_fir<coeffs>::process_block(array_view<const double> in, array_view<double> out) {
+    // Lay out the last taps - 1 inputs, oldest first,
+    // followed by the block itself
+    size_t len = in.size();
+    size_t hist_len = taps - 1;
+    block_buf.resize(hist_len + len);
+    std::copy(hist.begin() + pos + 1, hist.begin() + pos + taps, block_buf.begin());
+    std::copy(in.begin(), in.end(), block_buf.begin() + hist_len);
+
+    conv(block_buf.data(), out.data(), len);
+
+    // Only the newest inputs remain in the history
+    for (size_t i = len - std::min(len, taps); i < len; ++i) {
+        push_input(block_buf[hist_len + i]);
+    }
+}
+
+template<const auto &coeffs>
+void fixed_fir<coeffs>::set_isa(simd_isa isa) {
+    conv = select_kernel(isa);
+}
+
+template<const auto &coeffs>
+void fixed_fir<coeffs>::reset() {
+    hist.fill(0);
+    pos = 0;
+}
+
+#endif // TELEM_FILTER_FIXED_FIR_H
@@ -0,0 +1,208 @@
+#include "flight_batch.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+
+#include "csv_writer.h"
+#include "stage_graph.h"
+
+std::vector<std::string> find_flights(const std::string &path) {
+    std::error_code ec;
+    std::vector<std::string> flights;
+    if (std::filesystem::is_directory(path, ec)) {
+        for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator{path, ec}) {
+            std::string extension = entry.path().extension().string();
+            if (entry.is_regular_file(ec) && (extension == ".json" || extension == ".telem")) {
+                flights.push_back(entry.path().string());
+            }
+        }
+        if (ec) {
+            throw std::invalid_argument{"Flight directory could not be read."};
+        }
+
+        std::sort(flights.begin(), flights.end());
+        return flights;
+    }
+
+    std::ifstream manifest{path};
+    if (!manifest.good()) {
+        throw std::invalid_argument{"Flight manifest could not be opened."};
+    }
+
+    std::filesystem::path base = std::filesystem::path{path}.parent_path();
+    std::string line;
+    while (std::getline(manifest, line)) {
+        size_t begin = line.find_first_not_of(" \t\r");
+        if (begin == std::string::npos || line[begin] == '#') {
+            continue;
+        }
+        size_t end = line.find_last_not_of(" \t\r") + 1;
+
+        std::filesystem::path flight{line.substr(begin, end - begin)};
+        flights.push_back(flight.is_absolute() ? flight.string() : (base / flight).string());
+    }
+
+    return flights;
+}
+
+/**
+ * Loads, processes and writes one flight, recording the
+ * outcome in its summary.
+ *
+ * @param summary the summary of the flight, whose paths are
+ * set
+ * @param options the options of the pipeline run
+ * @param buffer the output buffer of the worker, whose
+ * contents are replaced
+ */
+static void process_flight(flight_summary &summary, const pipeline_options &options, std::string &buffer) {
+    auto start = std::chrono::steady_clock::now();
+    try {
+        pipeline_result result = run_pipeline(load_telemetry(summary.input_path, options.threads), options);
+
+        buffer.clear();
+        format_pipeline_csv(result, buffer);
+
+        std::ofstream output{summary.output_path, std::ios::binary | std::ios::trunc};
+        output.write(buffer.data(), buffer.size());
+        output.close();
+        if (!output.good()) {
+            throw std::invalid_argument{"Flight output could not be written."};
+        }
+
+        summary.samples = result.stage_3_data.size();
+        summary.velocities = result.stage_3.velocities.size();
+        for (double error : result.stage_3.velocity_errors) {
+            summary.max_velocity_error = std::max(summary.max_velocity_error, std::abs(error));
+        }
+        for (double error : result.stage_3.altitude_errors) {
+            summary.max_altitude_error = std::max(summary.max_altitude_error, std::abs(error));
+        }
+    } catch (const std::exception &e) {
+        summary.error = e.what();
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    summary.seconds = elapsed.count();
+}
+
+std::vector<flight_summary> process_flights(const std::vector<std::string> &flight_paths,
+                                            const std::string &output_dir,
+                                            pipeline_options options,
+                                            thread_pool &pool) {
+    std::vector<flight_summary> summaries(flight_paths.size());
+    std::string summary_path = (std::filesystem::path{output_dir} / BATCH_SUMMARY_NAME).string();
+    std::set<std::string> output_paths;
+    for (size_t i = 0; i < flight_paths.size(); ++i) {
+        std::filesystem::path output = std::filesystem::path{output_dir} / std::filesystem::path{flight_paths[i]}.stem();
+        output += ".csv";
+
+        summaries[i].input_path = flight_paths[i];
+        summaries[i].output_path = output.string();
+        if (summaries[i].output_path == summary_path) {
+            throw std::invalid_argument{"Flight would overwrite the batch summary: " + flight_paths[i]};
+        }
+        if (!output_paths.insert(summaries[i].output_path).second) {
+            throw std::invalid_argument{"Flights would be written to the same output: " + summaries[i].output_path};
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(output_dir, ec);
+    if (ec) {
+        throw std::invalid_argument{"Output directory could not be created."};
+    }
+
+    if (summaries.empty()) {
+        return summaries;
+    }
+
+    // Start the largest flights first so the batch does not
+    // end waiting on a long flight that started last.
+    // Unreadable files sort last and fail quickly.
+    std::vector<uintmax_t> sizes(flight_paths.size());
+    for (size_t i = 0; i < flight_paths.size(); ++i) {
+        uintmax_t size = std::filesystem::file_size(flight_paths[i], ec);
+        sizes[i] = ec ? 0 : size;
+    }
+    std::vector<size_t> order(flight_paths.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return sizes[a] > sizes[b];
+    });
+
+    // The flights are processed concurrently, so each is
+    // kept to one thread rather than oversubscribing the
+    // cores
+    options.threads = 1;
+
+    // Each flight is an independent node, balanced over the
+    // workers by the pool. Workers run the last task dealt
+    // to them first, so the flights are added smallest first
+    // for the largest to start first.
+    stage_graph graph;
+    std::vector<std::pair<size_t, stage_output<flight_summary>>> outputs;
+    outputs.reserve(order.size());
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        stage_output<flight_summary> output = graph.add([summary = summaries[*it], &options]() mutable {
+            // The buffer of each worker is reused from flight
+            // to flight
+            thread_local std::string buffer;
+            process_flight(summary, options, buffer);
+
+            return summary;
+        });
+        outputs.emplace_back(*it, output);
+    }
+
+    graph.run(pool);
+
+    for (const auto &[index, output] : outputs) {
+        summaries[index] = output.get();
+    }
+
+    return summaries;
+}
+
+/**
+ * Quotes a text field of a CSV file, doubling any quotes it
+ * contains.
+ *
+ * @param text the text
+ * @return the quoted field
+ */
+static std::string quote_field(const std::string &text) {
+    std::string field{'"'};
+    for (char c : text) {
+        if (c == '"') {
+            field += '"';
+        }
+        field += c;
+    }
+    field += '"';
+
+    return field;
+}
+
+void write_batch_summary(const std::vector<flight_summary> &summaries, const std::string &file_path) {
+    csv_writer csv{file_path};
+
+    csv << "input,output,samples,velocities,max_velocity_error,max_altitude_error,seconds,error\n";
+    for (const flight_summary &summary : summaries) {
+        csv << quote_field(summary.input_path) << ','
+            << quote_field(summary.output_path) << ','
+            << summary.samples << ','
+            << summary.velocities << ','
+            << summary.max_velocity_error << ','
+            << summary.max_altitude_error << ','
+            << summary.seconds << ','
+            << quote_field(summary.error) << '\n';
+    }
+}
@@ -0,0 +1,118 @@
+/**
+ * @file
+ */
+
+#ifndef TELEM_FILTER_FLIGHT_BATCH_H
+#define TELEM_FILTER_FLIGHT_BATCH_H
+
+#include <string>
+#include <vector>
+
+#include "telem_pipeline.h"
+#include "thread_pool.h"
+
+/**
+ * The name of the summary written to the output directory
+ * of a batch, which no flight output may take.
+ */
+static const char BATCH_SUMMARY_NAME[] = "summary.csv";
+
+/**
+ * @brief The outcome of processing one flight of a batch.
+ */
+struct flight_summary {
+    /**
+     * The path to the telemetry of the flight.
+     */
+    std::string input_path;
+    /**
+     * The path to the CSV file written for the flight.
+     */
+    std::string output_path;
+    /**
+     * The number of processed telemetry samples.
+     */
+    size_t samples{0};
+    /**
+     * The number of velocities produced by stage 3.
+     */
+    size_t velocities{0};
+    /**
+     * The largest magnitude of the stage 3 velocity errors,
+     * m/s.
+     */
+    double max_velocity_error{0};
+    /**
+     * The largest magnitude of the stage 3 altitude errors,
+     * km.
+     */
+    double max_altitude_error{0};
+    /**
+     * The time taken to load, process and write the flight,
+     * s.
+     */
+    double seconds{0};
+    /**
+     * The reason the flight could not be processed, which is
+     * empty if it succeeded.
+     */
+    std::string error;
+};
+
+/**
+ * Lists the telemetry files of a batch of flights.
+ *
+ * The path is either a directory, whose .json and .telem
+ * files are listed in name order, or a manifest file with
+ * one telemetry path per line. Blank lines and lines
+ * starting with # are skipped, and relative paths are
+ * resolved against the directory of the manifest.
+ *
+ * @param path the path to the directory or manifest
+ * @return the paths to the telemetry files
+ * @throws std::invalid_argument if the path cannot be read
+ */
+std::vector<std::string> find_flights(const std::string &path);
+
+/**
+ * Runs the pipeline on every flight of a batch on the given
+ * pool, writing the outputs of each flight to a CSV file of
+ * the same name in the output directory.
+ *
+ * Each flight is a node of a stage_graph run on the pool.
+ * Flights are started largest file first, so that the
+ * longest flights do not finish last on a single worker.
+ * Each worker processes one flight at a time on its own
+ * thread, whatever the thread count of the options, and
+ * reuses its output buffer from flight to flight. A flight
+ * which fails is recorded in its summary rather than
+ * stopping the batch. Must not be called from a task of the
+ * same pool.
+ *
+ * @param flight_paths the paths to the telemetry files
+ * @param output_dir the directory to write the outputs to,
+ * which is created if missing
+ * @param options the options of each pipeline run
+ * @param pool the pool on which to process the flights
+ * @return the summary of each flight, in the order given
+ * @throws std::invalid_argument if two flights would be
+ * written to the same output, or one to the batch summary,
+ * or the output directory cannot be created
+ */
+std::vector<flight_summary> process_flights(const std::vector<std::string> &flight_paths,
+                                            const std::string &output_dir,
+                                            pipeline_options options,
+                                            thread_pool &pool);
+
+/**
+ * Writes the summaries of a batch to a CSV file, one row
+ * per flight.
+ *
+ * @param summaries the summaries of the flights
+ * @param file_path the path to the CSV file to write
+ * @throws std::invalid_argument if the file cannot be
+ * opened
+ */
+void write_batch_summary(const std::vector<flight_summary> &summaries, const std::string &file_path);
+
+#endif // TELEM_FILTER_FLIGHT_BATCH_H
@@ -0,0 +1,75 @@
+#include "fused_stages.h"
+
+#include <algorithm>
+#include <array>
+
+/**
+ * The number of velocities filtered at a time, which keeps
+ * the filtered block in the L1 cache until it is used.
+ */
+static const size_t FUSED_BLOCK_SIZE = 512;
+
+fused_stage_outputs fuse_stages_2_3(velocity_series_view v_stage_1,
+                                    const telem_data &processed_data,
+                                    stage_2_lpf lpf_type,
+                                    unsigned int threads) {
+    unsigned int filter_delay;
+    std::unique_ptr<signal_filter> x_lpf = make_stage_2_stream_lpf(lpf_type, filter_delay);
+    std::unique_ptr<signal_filter> y_lpf = make_stage_2_stream_lpf(lpf_type, filter_delay);
+
+    size_t len = v_stage_1.size();
+    size_t out_len = len > filter_delay ? len - filter_delay : 0;
+
+    fused_stage_outputs outputs;
+    outputs.stage_2.reserve(out_len);
+    outputs.stage_3.reserve(out_len);
+    outputs.stage_2_velocity_errors.reserve(out_len);
+    outputs.stage_3_velocity_errors.reserve(out_len);
+    outputs.altitude_errors.reserve(out_len);
+
+    array_view<const double> result_times = v_stage_1.get_times();
+    array_view<const double> x_velocities = v_stage_1.get_x();
+    array_view<const double> y_velocities = v_stage_1.get_y();
+
+    array_view<const double> times = processed_data.get_times();
+    array_view<const double> velocities = processed_data.get_velocities();
+    array_view<const double> altitudes = processed_data.get_altitudes();
+
+    std::array<double, FUSED_BLOCK_SIZE> x_filtered{};
+    std::array<double, FUSED_BLOCK_SIZE> y_filtered{};
+
+    for (size_t begin = 0; begin < len; begin += FUSED_BLOCK_SIZE) {
+        size_t count = std::min(FUSED_BLOCK_SIZE, len - begin);
+        x_lpf->process_block(x_velocities.subview(begin, count), {x_filtered.data(), count});
+        y_lpf->process_block(y_velocities.subview(begin, count), {y_filtered.data(), count});
+
+        // Outputs preceding the filter delay are dropped, as
+        // in stage 2, so the rest line up with the telemetry
+        for (size_t j = begin < filter_delay ? filter_delay - begin : 0; j < count; ++j) {
+            size_t k = begin + j - filter_delay;
+            double v = velocities[k];
+
+            // Stage 2
+            vector2d v_filtered{x_filtered[j], y_filtered[j]};
+            outputs.stage_2.push_back(result_times[begin + j], v_filtered);
+            outputs.stage_2_velocity_errors.push_back(v_filtered.mag() - v);
+
+            // Stage 3, which keeps the filtered v_y and
+            // adjusts v_x to the telemetry magnitude
+            double v_y_f = v_filtered.get_y();
+            vector2d v_adjusted = adjust_velocity(v, v_y_f);
+            outputs.stage_3.push_back(times[k], v_adjusted);
+            outputs.stage_3_velocity_errors.push_back(v_adjusted.mag() - v);
+        }
+    }
+
+    // The running sum is the one dependency between the
+    // velocities, so it is left to the compensated prefix sum
+    // of the stages rather than carried through the pass
+    std::vector<double> v_y_f_integral = processed_data.integrate(outputs.stage_3.view().get_y(), threads);
+    for (size_t k = 0; k < v_y_f_integral.size(); ++k) {
+        outputs.altitude_errors.push_back(v_y_f_integral[k] / 1000 - altitudes[k]);
+    }
+
+    return outputs;
+}
@@ -0,0 +1,77 @@
+/**
+ * @file
+ */
+
+#ifndef TELEM_FILTER_FUSED_STAGES_H
+#define TELEM_FILTER_FUSED_STAGES_H
+
+#include <vector>
+
+#include "telem_data.h"
+#include "telem_pipeline.h"
+#include "velocity_series.h"
+
+/**
+ * @brief The outputs of stages 2 and 3 computed together
+ * by fuse_stages_2_3().
+ *
+ * Every column has one element per velocity of the stage
+ * results, which are paired with the processed telemetry
+ * data at the same index.
+ */
+struct fused_stage_outputs {
+    /**
+     * The filtered velocities, as in the result of stage 2.
+     */
+    velocity_series stage_2;
+    /**
+     * The adjusted velocities, as in the result of stage 3.
+     */
+    velocity_series stage_3;
+    /**
+     * The difference between the magnitude of each filtered
+     * velocity and the telemetry velocity, m/s.
+     */
+    std::vector<double> stage_2_velocity_errors;
+    /**
+     * The difference between the magnitude of each adjusted
+     * velocity and the telemetry velocity, m/s.
+     */
+    std::vector<double> stage_3_velocity_errors;
+    /**
+     * The difference between the integrated and telemetry
+     * altitudes, km, which is shared by both stages as the
+     * adjustment keeps the filtered vertical velocity.
+     */
+    std::vector<double> altitude_errors;
+};
+
+/**
+ * Computes the outputs of stages 2 and 3 from the result of
+ * stage 1 in a single pass.
+ *
+ * The velocities are filtered a block at a time, and each
+ * block is adjusted and compared to the telemetry while it
+ * is still in cache, so every input column is read once and
+ * every output column written once. The filtered vertical
+ * velocities are then integrated by telem_data::integrate()
+ * for the altitude errors. The outputs match those of
+ * process_stage_2() followed by process_stage_3(), up to
+ * rounding error, without plotting them.
+ *
+ * @param v_stage_1 the result of stage 1
+ * @param processed_data the processed telemetry data of
+ * stage 1
+ * @param lpf_type the low-pass filter design of stage 2
+ * @param threads the maximum number of threads to use, or
+ * 0 to use one thread per hardware core
+ * @return the outputs of both stages
+ * @throws std::invalid_argument if the filter is
+ * zero-phase, which requires a pass of its own
+ */
+fused_stage_outputs fuse_stages_2_3(velocity_series_view v_stage_1,
+                                    const telem_data &processed_data,
+                                    stage_2_lpf lpf_type = stage_2_lpf::parks_mcclellan,
+                                    unsigned int threads = 0);
+
+#endif // TELEM_FILTER_FUSED_STAGES_H
@@ -2,33 +2,86 @@
  * @file
  */
 
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include <mgl2/fltk.h>
 
 #include "stage_3_plotter.h"
+#include "telem_cache.h"
+
+/**
+ * Opens a window for each of the given stages and runs them
+ * all, in order.
+ *
+ * @param stages each stage with the title of its window,
+ * each stage being created before the stages it streams to
+ * are run
+ * @return 0 on success
+ */
+static int run_stages(const std::vector<std::pair<mgl_plotter *, const char *>> &stages) {
+    std::vector<std::unique_ptr<mglFLTK>> windows;
+    for (const auto &[stage, title] : stages) {
+        windows.push_back(std::make_unique<mglFLTK>(stage, title));
+        stage->set_wnd(windows.back().get());
+    }
+
+    for (const auto &stage : stages) {
+        stage.first->Run();
+    }
+
+    return mgl_fltk_run();
+}
 
 /**
  * The main function of the program.
  *
+ * @param argc the number of arguments
+ * @param argv optionally, --decimate and the factor by
+ * which to decimate the stage 2 velocities before stage 3
  * @return 0 on success
  */
-int main() {
-    telem_data_json raw_data{"./data/data.json"};
+int main(int argc, char **argv) {
+    unsigned long decimation_factor = 0;
+    try {
+        if (argc == 3 && std::strcmp(argv[1], "--decimate") == 0) {
+            decimation_factor = std::stoul(argv[2]);
+        } else if (argc != 1) {
+            throw std::invalid_argument{"Unknown arguments."};
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "Usage: " << argv[0] << " [--decimate N]" << std::endl;
+        return 1;
+    }
 
-    stage_1_plotter stage_1{raw_data};
-    stage_2_plotter stage_2{stage_1};
-    stage_3_plotter stage_3{stage_2};
+    telem_data_cache raw_data{"./data/data.json", "./data/data.telem"};
 
-    mglFLTK mgl_stage_1{&stage_1, "Stage 1"};
-    mglFLTK mgl_stage_2{&stage_2, "Stage 2"};
-    mglFLTK mgl_stage_3{&stage_3, "Stage 3"};
+    stage_1_plotter stage_1{raw_data, stage_1_grid::uniform_linear};
+    // Stages 2 and 3 process each velocity as soon as their
+    // prior stage emits it, rather than once it has finished
+    stage_2_plotter stage_2{stage_1, stage_2_lpf::parks_mcclellan, pipeline_mode::streaming};
 
-    stage_1.set_wnd(&mgl_stage_1);
-    stage_2.set_wnd(&mgl_stage_2);
-    stage_3.set_wnd(&mgl_stage_3);
+    // Stage 3 processes every stage 2 velocity unless
+    // decimation is requested, which trades accuracy for
+    // fewer velocities
+    if (decimation_factor == 0) {
+        stage_3_plotter stage_3{stage_2, pipeline_mode::streaming};
 
-    stage_1.Run();
-    stage_2.Run();
-    stage_3.Run();
+        return run_stages({{&stage_1, "Stage 1"},
+                           {&stage_2, "Stage 2"},
+                           {&stage_3, "Stage 3"}});
+    }
 
-    return mgl_fltk_run();
+    decimation_plotter stage_2_decimated{stage_2, static_cast<unsigned int>(decimation_factor)};
+    stage_3_plotter stage_3{stage_2_decimated, pipeline_mode::streaming};
+
+    return run_stages({{&stage_1, "Stage 1"},
+                       {&stage_2, "Stage 2"},
+                       {&stage_2_decimated, "Stage 2 (Decimated)"},
+                       {&stage_3, "Stage 3"}});
 }
@@ -0,0 +1,73 @@
+#include "mapped_file.h"
+
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+mapped_file::mapped_file(const std::string &file_path) {
+    int fd = open(file_path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::invalid_argument{"File could not be opened."};
+    }
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        throw std::invalid_argument{"File could not be opened."};
+    }
+
+    len = static_cast<size_t>(st.st_size);
+
+    // Zero-length mappings are not permitted
+    if (len != 0) {
+        void *addr = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            close(fd);
+            throw std::invalid_argument{"File could not be mapped."};
+        }
+
+        madvise(addr, len, MADV_SEQUENTIAL);
+        ptr = static_cast<const char *>(addr);
+    }
+
+    // The mapping remains valid after the descriptor closes
+    close(fd);
+}
+
+mapped_file::~mapped_file() {
+    if (ptr != nullptr) {
+        munmap(const_cast<char *>(ptr), len);
+    }
+}
+
+mapped_file::mapped_file(mapped_file &&other) noexcept :
+        ptr(other.ptr), len(other.len) {
+    other.ptr = nullptr;
+    other.len = 0;
+}
+
+mapped_file &mapped_file::operator=(mapped_file &&other) noexcept {
+    if (this != &other) {
+        if (ptr != nullptr) {
+            munmap(const_cast<char *>(ptr), len);
+        }
+
+        ptr = other.ptr;
+        len = other.len;
+        other.ptr = nullptr;
+        other.len = 0;
+    }
+
+    return *this;
+}
+
+const char *mapped_file::data() const {
+    return ptr;
+}
+
+size_t mapped_file::size() const {
+    return len;
+}
@@ -0,0 +1,84 @@
+/**
+ * @file
+ */
+
+#ifndef TELEM_FILTER_MAPPED_FILE_H
+#define TELEM_FILTER_MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief Represents a read-only memory mapping of an entire
+ * file.
+ *
+ * Mapping the file rather than reading it through a stream
+ * avoids copying its contents into the process and allows
+ * repeated runs to reuse the pages already held in the OS
+ * page cache.
+ */
+class mapped_file {
+private:
+    /**
+     * The pointer to the start of the mapping, or nullptr
+     * if the file is empty.
+     */
+    const char *ptr{nullptr};
+    /**
+     * The size of the mapping, in bytes.
+     */
+    size_t len{0};
+
+public:
+    /**
+     * Maps the file at the given path into memory.
+     *
+     * @param file_path the path to the file to map
+     * @throws std::invalid_argument if the file cannot be
+     * opened or mapped
+     */
+    explicit mapped_file(const std::string &file_path);
+
+    /**
+     * Destructor. Unmaps the file.
+     */
+    ~mapped_file();
+
+    mapped_file(const mapped_file &) = delete;
+
+    mapped_file &operator=(const mapped_file &) = delete;
+
+    /**
+     * Transfers the mapping from another instance, which is
+     * left empty.
+     *
+     * @param other the instance to take the mapping from
+     */
+    mapped_file(mapped_file &&other) noexcept;
+
+    /**
+     * Unmaps this file and takes over the mapping of
+     * another instance, which is left empty.
+     *
+     * @param other the instance to take the mapping from
+     * @return this instance
+     */
+    mapped_file &operator=(mapped_file &&other) noexcept;
+
+    /**
+     * Obtains the pointer to the first byte of the file.
+     *
+     * @return the file contents, or nullptr if the file is
+     * empty
+     */
+    [[nodiscard]] const char *data() const;
+
+    /**
+     * Obtains the size of the mapped file.
+     *
+     * @return the number of bytes in the file
+     */
+    [[nodiscard]] size_t size() const;
+};
+
+#endif // TELEM_FILTER_MAPPED_FILE_H
@@ -0,0 +1,155 @@
+#include "plateau_lerp.h"
+
+#include <algorithm>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include "fir_kernels.h"
+
+#ifdef TELEM_FILTER_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * The smallest chunk worth handing to its own thread, in
+ * samples. Shorter signals are processed with fewer
+ * threads.
+ */
+static const size_t MIN_CHUNK_SIZE = 256 * 1024;
+
+/**
+ * Finds the first kept sample at or after the given index,
+ * being the last sample or one differing from the sample
+ * before. Pairs of samples are compared at a time, so long
+ * plateaus are skipped quickly.
+ *
+ * @param v the input values
+ * @param len the number of values
+ * @param i the index from which to search, which must be
+ * nonzero and less than len
+ * @return the index of the kept sample
+ */
+static size_t find_kept(const double *v, size_t len, size_t i) {
+#ifdef TELEM_FILTER_X86
+    for (; i + 2 < len; i += 2) {
+        int changed = _mm_movemask_pd(_mm_cmpneq_pd(_mm_loadu_pd(v + i), _mm_loadu_pd(v + i - 1)));
+        if (changed != 0) {
+            return (changed & 1) != 0 ? i : i + 1;
+        }
+    }
+#endif
+    for (; i + 1 < len; ++i) {
+        if (v[i] != v[i - 1]) {
+            return i;
+        }
+    }
+
+    return len - 1;
+}
+
+/**
+ * Fills the given range with an affine ramp over the times.
+ *
+ * @param t the time of each value
+ * @param y the output values
+ * @param begin the index of the first value to fill
+ * @param end the index past the last value to fill
+ * @param t_left the time at which the ramp has its base
+ * value
+ * @param v_left the base value
+ * @param slope the slope of the ramp
+ */
+static void fill_ramp(const double *t, double *y, size_t begin, size_t end,
+                      double t_left, double v_left, double slope) {
+    size_t j = begin;
+#ifdef TELEM_FILTER_X86
+    __m128d base = _mm_set1_pd(v_left);
+    __m128d origin = _mm_set1_pd(t_left);
+    __m128d gain = _mm_set1_pd(slope);
+    for (; j + 2 <= end; j += 2) {
+        __m128d dt = _mm_sub_pd(_mm_loadu_pd(t + j), origin);
+        _mm_storeu_pd(y + j, _mm_add_pd(base, _mm_mul_pd(gain, dt)));
+    }
+#endif
+    for (; j < end; ++j) {
+        y[j] = v_left + slope * (t[j] - t_left);
+    }
+}
+
+/**
+ * Replaces the runs starting at a kept sample in the given
+ * range by the lines through the kept samples at either
+ * end. The last run may end past the range.
+ *
+ * @param times the time of each value
+ * @param in the input values
+ * @param out the output values
+ * @param begin the index of the first sample of the range
+ * @param end the index past the last sample of the range
+ */
+static void lerp_runs(array_view<const double> times,
+                      array_view<const double> in,
+                      array_view<double> out,
+                      size_t begin,
+                      size_t end) {
+    size_t len = in.size();
+    if (begin >= end) {
+        return;
+    }
+
+    const double *t = times.data();
+    const double *v = in.data();
+    double *y = out.data();
+
+    // The samples preceding the first kept one belong to a
+    // run of the previous range
+    size_t left = begin == 0 ? 0 : find_kept(v, len, begin);
+    if (left >= end) {
+        return;
+    }
+    y[left] = v[left];
+
+    while (left < end && left + 1 < len) {
+        size_t right = find_kept(v, len, left + 1);
+
+        double t_left = t[left];
+        double v_left = v[left];
+        double slope = (v[right] - v_left) / (t[right] - t_left);
+        fill_ramp(t, y, left + 1, right, t_left, v_left, slope);
+
+        // A kept sample past the range starts a run of the
+        // next range, which sets it
+        if (right < end) {
+            y[right] = v[right];
+        }
+        left = right;
+    }
+}
+
+void plateau_lerp(array_view<const double> times,
+                  array_view<const double> in,
+                  array_view<double> out,
+                  unsigned int threads) {
+    size_t len = in.size();
+    if (threads == 0) {
+        threads = std::max(1U, std::thread::hardware_concurrency());
+    }
+    size_t chunks = std::min<size_t>(threads, len / MIN_CHUNK_SIZE + 1);
+
+    // Each chunk fills the runs starting in it, so the
+    // chunks are independent. Process each on its own
+    // thread, keeping the first chunk for the calling thread
+    std::vector<std::future<void>> tasks;
+    for (size_t c = 1; c < chunks; ++c) {
+        tasks.push_back(std::async(std::launch::async, [&, c]() {
+            lerp_runs(times, in, out, len * c / chunks, len * (c + 1) / chunks);
+        }));
+    }
+
+    lerp_runs(times, in, out, 0, len / chunks);
+
+    for (auto &task : tasks) {
+        task.get();
+    }
+}
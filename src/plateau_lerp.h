@@ -0,0 +1,39 @@
+/**
+ * @file
+ */
+
+#ifndef TELEM_FILTER_PLATEAU_LERP_H
+#define TELEM_FILTER_PLATEAU_LERP_H
+
+#include "array_view.h"
+
+/**
+ * Replaces the plateaus of a signal which is updated less
+ * often than it is sampled by straight lines between the
+ * samples at which its value changes.
+ *
+ * The samples at which the value differs from the one
+ * before, as well as the first and last samples, are kept.
+ * Every other sample is then set by the line through the
+ * kept samples either side of it at its time.
+ *
+ * The end of each run is found by comparing pairs of
+ * samples to their predecessors at a time, then the run is
+ * filled by an affine ramp over the times, a vectorized
+ * loop over contiguous arrays. Runs are independent, so the
+ * signal can be split into chunks processed in parallel,
+ * each filling the runs which start in it.
+ *
+ * @param times the time of each value
+ * @param in the input values
+ * @param out the output values, of the same length as the
+ * input
+ * @param threads the number of threads to use, or 0 to use
+ * one thread per hardware core
+ */
+void plateau_lerp(array_view<const double> times,
+                  array_view<const double> in,
+                  array_view<double> out,
+                  unsigned int threads = 1);
+
+#endif // TELEM_FILTER_PLATEAU_LERP_H
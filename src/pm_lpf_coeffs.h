@@ -0,0 +1,37 @@
+/**
+ * @file
+ */
+
+#ifndef TELEM_FILTER_PM_LPF_COEFFS_H
+#define TELEM_FILTER_PM_LPF_COEFFS_H
+
+#include <array>
+
+#include "fixed_fir.h"
+
+/**
+ * Parks-McClellan FIR coefficients:
+ *   - 0-1 Hz break frequencies
+ *   - 0.001 ripple deviation
+ *   - LPF [1 0] coefficients
+ *   - Sampled at ~30 Hz
+ *
+ * Filter coefficients generated with MATLAB.
+ */
+static constexpr std::array<double, 100> PM_LPF_COEFFS = {
+        0.0001, 0.0001, 0.0001, 0.0001, 0.0002, 0.0003, 0.0003, 0.0004, 0.0006, 0.0007, 0.0009, 0.0011,
+        0.0013, 0.0016, 0.0019, 0.0022, 0.0026, 0.0030, 0.0035, 0.0040, 0.0045, 0.0051, 0.0058, 0.0065,
+        0.0072, 0.0079, 0.0087, 0.0096, 0.0104, 0.0113, 0.0123, 0.0132, 0.0141, 0.0151, 0.0160, 0.0169,
+        0.0178, 0.0187, 0.0195, 0.0203, 0.0211, 0.0218, 0.0224, 0.0230, 0.0235, 0.0239, 0.0243, 0.0246,
+        0.0247, 0.0248, 0.0248, 0.0247, 0.0246, 0.0243, 0.0239, 0.0235, 0.0230, 0.0224, 0.0218, 0.0211,
+        0.0203, 0.0195, 0.0187, 0.0178, 0.0169, 0.0160, 0.0151, 0.0141, 0.0132, 0.0123, 0.0113, 0.0104,
+        0.0096, 0.0087, 0.0079, 0.0072, 0.0065, 0.0058, 0.0051, 0.0045, 0.0040, 0.0035, 0.0030, 0.0026,
+        0.0022, 0.0019, 0.0016, 0.0013, 0.0011, 0.0009, 0.0007, 0.0006, 0.0004, 0.0003, 0.0003, 0.0002,
+        0.0001, 0.0001, 0.0001, 0.0001
+};
+
+// A miscounted table would silently lose its folded taps
+static_assert(fixed_fir<PM_LPF_COEFFS>::symmetry == fir_symmetry::symmetric,
+              "The Parks-McClellan coefficients must be symmetric");
+
+#endif // TELEM_FILTER_PM_LPF_COEFFS_H
@@ -0,0 +1,212 @@
+#include "polyphase_filter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+/**
+ * Splits the filter coefficients into the given number of
+ * polyphase branches, padding the filter with zeros to a
+ * multiple of the branch count.
+ *
+ * @param b the numerator coefficients
+ * @param factor the number of branches
+ * @return the branch filters, the p-th of which holds the
+ * coefficients b[k * factor + p]
+ * @throws std::invalid_argument if the factor is zero or
+ * there are no coefficients
+ */
+static std::vector<digital_filter> split_phases(const std::vector<double> &b, size_t factor) {
+    if (factor == 0 || b.empty()) {
+        throw std::invalid_argument{"Polyphase filter requires coefficients and a nonzero factor."};
+    }
+
+    size_t branch_taps = (b.size() + factor - 1) / factor;
+    std::vector<digital_filter> branches;
+    branches.reserve(factor);
+    for (size_t p = 0; p < factor; ++p) {
+        std::vector<double> branch_b(branch_taps, 0);
+        for (size_t k = 0; k < branch_taps && k * factor + p < b.size(); ++k) {
+            branch_b[k] = b[k * factor + p];
+        }
+
+        branches.emplace_back(std::move(branch_b));
+    }
+
+    return branches;
+}
+
+polyphase_decimator::polyphase_decimator(std::vector<double> b, size_t factor) :
+        factor(factor),
+        branches(split_phases(b, factor)),
+        pending(factor, 0) {
+}
+
+size_t polyphase_decimator::get_factor() const {
+    return factor;
+}
+
+size_t polyphase_decimator::output_size(size_t len) const {
+    // Outputs fall on the inputs whose index is a multiple
+    // of the factor
+    size_t first = (factor - phase) % factor;
+    return len <= first ? 0 : 1 + (len - 1 - first) / factor;
+}
+
+std::vector<double> polyphase_decimator::transform(array_view<const double> signal) const {
+    polyphase_decimator stream{*this};
+    stream.reset();
+
+    std::vector<double> result(stream.output_size(signal.size()));
+    stream.process_block(signal, result);
+
+    return result;
+}
+
+std::vector<std::vector<double>> polyphase_decimator::transform_channels(
+        const std::vector<array_view<const double>> &signals) const {
+    size_t len = channel_length(signals);
+    size_t channels = signals.size();
+    size_t count = (len + factor - 1) / factor;
+
+    // Deal the inputs out to the branches as process_block()
+    // does from rest. Input m * factor - p feeds branch p
+    // for output m, and is zero before the start
+    std::vector<double> phase_in(factor * channels * count, 0);
+    std::vector<array_view<const double>> branch_in(factor * channels);
+    for (size_t p = 0; p < factor; ++p) {
+        for (size_t c = 0; c < channels; ++c) {
+            double *phase = phase_in.data() + (p * channels + c) * count;
+            for (size_t m = p == 0 ? 0 : 1; m < count; ++m) {
+                phase[m] = signals[c][m * factor - p];
+            }
+            branch_in[p * channels + c] = {phase, count};
+        }
+    }
+
+    std::vector<std::vector<double>> results = branches[0].transform_channels(
+            {branch_in.begin(), branch_in.begin() + channels});
+    for (size_t p = 1; p < factor; ++p) {
+        std::vector<std::vector<double>> branch_out = branches[p].transform_channels(
+                {branch_in.begin() + p * channels, branch_in.begin() + (p + 1) * channels});
+        for (size_t c = 0; c < channels; ++c) {
+            for (size_t i = 0; i < count; ++i) {
+                results[c][i] += branch_out[c][i];
+            }
+        }
+    }
+
+    return results;
+}
+
+size_t polyphase_decimator::process_block(array_view<const double> in, array_view<double> out) {
+    size_t count = output_size(in.size());
+    phase_buf.resize(count * factor);
+
+    // Deal the inputs out to the branches. Input m * factor
+    // - p feeds branch p for output m, and arrives before
+    // it unless p is zero
+    size_t o = 0;
+    for (double x : in) {
+        if (phase == 0) {
+            phase_buf[o] = x;
+            for (size_t p = 1; p < factor; ++p) {
+                phase_buf[p * count + o] = pending[p];
+            }
+            ++o;
+        } else {
+            pending[factor - phase] = x;
+        }
+
+        phase = phase + 1 == factor ? 0 : phase + 1;
+    }
+
+    array_view<double> result = out.subview(0, count);
+    branches[0].process_block({phase_buf.data(), count}, result);
+
+    branch_out.resize(count);
+    for (size_t p = 1; p < factor; ++p) {
+        branches[p].process_block({phase_buf.data() + p * count, count}, branch_out);
+        for (size_t i = 0; i < count; ++i) {
+            result[i] += branch_out[i];
+        }
+    }
+
+    return count;
+}
+
+void polyphase_decimator::reset() {
+    for (auto &branch : branches) {
+        branch.reset();
+    }
+
+    std::fill(pending.begin(), pending.end(), 0);
+    phase = 0;
+}
+
+std::vector<double> polyphase_decimator::design_lowpass(size_t factor, size_t delay) {
+    if (factor == 0) {
+        throw std::invalid_argument{"Polyphase filter requires a nonzero factor."};
+    }
+
+    size_t center = delay * factor;
+    size_t taps = 2 * center + 1;
+    std::vector<double> b(taps);
+
+    // Compute the first half and mirror it so the filter is
+    // exactly symmetric
+    double sum = 0;
+    for (size_t n = 0; n <= center; ++n) {
+        double x = (static_cast<double>(n) - static_cast<double>(center)) / static_cast<double>(factor);
+        double sinc = n == center ? 1 : std::sin(M_PI * x) / (M_PI * x);
+        double window = taps == 1 ? 1 : 0.54 - 0.46 * std::cos(2 * M_PI * n / (taps - 1));
+
+        b[n] = sinc * window;
+        b[taps - 1 - n] = b[n];
+        sum += n == center ? b[n] : 2 * b[n];
+    }
+
+    for (double &coeff : b) {
+        coeff /= sum;
+    }
+
+    return b;
+}
+
+polyphase_interpolator::polyphase_interpolator(std::vector<double> b, size_t factor) :
+        factor(factor),
+        branches(split_phases(b, factor)) {
+}
+
+size_t polyphase_interpolator::get_factor() const {
+    return factor;
+}
+
+std::vector<double> polyphase_interpolator::transform(array_view<const double> signal) const {
+    polyphase_interpolator stream{*this};
+    stream.reset();
+
+    std::vector<double> result(signal.size() * factor);
+    stream.process_block(signal, result);
+
+    return result;
+}
+
+void polyphase_interpolator::process_block(array_view<const double> in, array_view<double> out) {
+    size_t len = in.size();
+    branch_out.resize(len);
+
+    // Branch p produces output m * factor + p
+    for (size_t p = 0; p < factor; ++p) {
+        branches[p].process_block(in, branch_out);
+        for (size_t i = 0; i < len; ++i) {
+            out[i * factor + p] = branch_out[i];
+        }
+    }
+}
+
+void polyphase_interpolator::reset() {
+    for (auto &branch : branches) {
+        branch.reset();
+    }
+}
@@ -0,0 +1,223 @@
+/**
+ * @file
+ */
+
+#ifndef TELEM_FILTER_POLYPHASE_FILTER_H
+#define TELEM_FILTER_POLYPHASE_FILTER_H
+
+#include <vector>
+
+#include "array_view.h"
+#include "digital_filter.h"
+
+/**
+ * @brief An FIR low-pass filter combined with downsampling
+ * by an integer factor, which keeps every factor-th output
+ * of the filter.
+ *
+ * The filter is split into factor polyphase branches, the
+ * p-th of which holds the coefficients b[k * factor + p]
+ * and filters every factor-th input sample. The branches
+ * run at the reduced rate and their outputs are summed, so
+ * only the outputs that are kept are ever computed.
+ *
+ * Like digital_filter, the decimator streams blocks of any
+ * size. The output with index m corresponds to the input
+ * with index m * factor.
+ */
+class polyphase_decimator {
+private:
+    /**
+     * The downsampling factor.
+     */
+    size_t factor;
+    /**
+     * The polyphase branches of the filter.
+     */
+    std::vector<digital_filter> branches;
+
+    /**
+     * The index of the next input sample, modulo the
+     * factor.
+     */
+    size_t phase{0};
+    /**
+     * The most recent input sample destined for each
+     * branch other than the first, awaiting the next
+     * output.
+     */
+    std::vector<double> pending;
+
+    /**
+     * Scratch buffer holding the input of each branch for
+     * the current block, one branch after another.
+     */
+    std::vector<double> phase_buf;
+    /**
+     * Scratch buffer holding the output of a branch.
+     */
+    std::vector<double> branch_out;
+
+public:
+    /**
+     * Creates a new decimator with the given filter
+     * coefficients.
+     *
+     * @param b the numerator coefficients of the low-pass
+     * filter at the input rate
+     * @param factor the downsampling factor
+     * @throws std::invalid_argument if the factor is zero or
+     * there are no coefficients
+     */
+    polyphase_decimator(std::vector<double> b, size_t factor);
+
+    /**
+     * Obtains the downsampling factor.
+     *
+     * @return the factor
+     */
+    [[nodiscard]] size_t get_factor() const;
+
+    /**
+     * Determines how many outputs the next block of input
+     * produces.
+     *
+     * @param len the length of the next block
+     * @return the number of outputs
+     */
+    [[nodiscard]] size_t output_size(size_t len) const;
+
+    /**
+     * Decimates a signal from rest, without using or
+     * modifying the streaming state of this decimator.
+     *
+     * @param signal the signal to decimate
+     * @return the decimated signal, of length
+     * ceil(signal.size() / factor)
+     */
+    std::vector<double> transform(array_view<const double> signal) const;
+
+    /**
+     * Decimates each channel of a multi-channel signal from
+     * rest, as transform() does for one.
+     *
+     * Each polyphase branch filters its share of every
+     * channel together in a single pass with
+     * digital_filter::transform_channels().
+     *
+     * @param signals the channels to decimate, which must
+     * have the same length
+     * @return the decimated channels, in the same order
+     * @throws std::invalid_argument if the channels differ
+     * in length
+     */
+    std::vector<std::vector<double>> transform_channels(
+            const std::vector<array_view<const double>> &signals) const;
+
+    /**
+     * Decimates the next block of the stream.
+     *
+     * @param in the input samples
+     * @param out the output samples, which must hold at
+     * least output_size(in.size()) elements
+     * @return the number of outputs written
+     */
+    size_t process_block(array_view<const double> in, array_view<double> out);
+
+    /**
+     * Resets the stream to rest.
+     */
+    void reset();
+
+    /**
+     * Designs a Hamming-windowed sinc low-pass filter
+     * suitable for decimating by the given factor, with its
+     * cutoff at the Nyquist frequency of the reduced rate
+     * and unity gain at DC.
+     *
+     * The filter has 2 * delay * factor + 1 taps, so it
+     * delays its input by exactly delay outputs.
+     *
+     * @param factor the downsampling factor
+     * @param delay the delay of the filter, in outputs
+     * @return the filter coefficients
+     */
+    static std::vector<double> design_lowpass(size_t factor, size_t delay);
+};
+
+/**
+ * @brief Upsampling by an integer factor combined with an
+ * FIR low-pass filter, which interpolates between the
+ * input samples.
+ *
+ * Rather than filtering the input padded with zeros, the
+ * filter is split into factor polyphase branches, the p-th
+ * of which holds the coefficients b[k * factor + p] and
+ * produces every factor-th output directly from the input.
+ *
+ * The filter should have a gain equal to the factor, as
+ * with polyphase_decimator::design_lowpass() scaled by the
+ * factor, to preserve the amplitude of the signal.
+ */
+class polyphase_interpolator {
+private:
+    /**
+     * The upsampling factor.
+     */
+    size_t factor;
+    /**
+     * The polyphase branches of the filter.
+     */
+    std::vector<digital_filter> branches;
+
+    /**
+     * Scratch buffer holding the output of a branch.
+     */
+    std::vector<double> branch_out;
+
+public:
+    /**
+     * Creates a new interpolator with the given filter
+     * coefficients.
+     *
+     * @param b the numerator coefficients of the low-pass
+     * filter at the output rate
+     * @param factor the upsampling factor
+     * @throws std::invalid_argument if the factor is zero or
+     * there are no coefficients
+     */
+    polyphase_interpolator(std::vector<double> b, size_t factor);
+
+    /**
+     * Obtains the upsampling factor.
+     *
+     * @return the factor
+     */
+    [[nodiscard]] size_t get_factor() const;
+
+    /**
+     * Interpolates a signal from rest, without using or
+     * modifying the streaming state of this interpolator.
+     *
+     * @param signal the signal to interpolate
+     * @return the interpolated signal, of length
+     * signal.size() * factor
+     */
+    std::vector<double> transform(array_view<const double> signal) const;
+
+    /**
+     * Interpolates the next block of the stream.
+     *
+     * @param in the input samples
+     * @param out the output samples, which must hold
+     * in.size() * factor elements
+     */
+    void process_block(array_view<const double> in, array_view<double> out);
+
+    /**
+     * Resets the stream to rest.
+     */
+    void reset();
+};
+
+#endif // TELEM_FILTER_POLYPHASE_FILTER_H
@@ -0,0 +1,163 @@
+#include "prefix_sum.h"
+
+#include <algorithm>
+#include <future>
+#include <thread>
+#include <vector>
+
+/**
+ * The smallest chunk worth handing to its own thread, in
+ * terms. Shorter inputs are scanned with fewer threads.
+ */
+static const size_t MIN_CHUNK_SIZE = 256 * 1024;
+
+/**
+ * @brief A running sum and the rounding error not yet
+ * added to it, which is always zero for plain summation.
+ */
+struct running_sum {
+    /**
+     * The sum.
+     */
+    double sum{0};
+    /**
+     * The compensation, being the negated rounding error of
+     * the sum.
+     */
+    double compensation{0};
+};
+
+/**
+ * Adds a term to a running sum.
+ *
+ * @tparam method the method of accumulating the sum
+ * @param acc the running sum
+ * @param term the term to add
+ */
+template<summation method>
+static void accumulate(running_sum &acc, double term) {
+    if constexpr (method == summation::plain) {
+        acc.sum += term;
+    } else {
+        double y = term - acc.compensation;
+        double t = acc.sum + y;
+        acc.compensation = (t - acc.sum) - y;
+        acc.sum = t;
+    }
+}
+
+/**
+ * Sums a range of terms.
+ *
+ * @tparam method the method of accumulating the sum
+ * @param in the terms
+ * @param begin the index of the first term
+ * @param end the index past the last term
+ * @return the sum, with its compensation
+ */
+template<summation method>
+static running_sum reduce(const double *in, size_t begin, size_t end) {
+    running_sum acc;
+    for (size_t i = begin; i < end; ++i) {
+        accumulate<method>(acc, in[i]);
+    }
+
+    return acc;
+}
+
+/**
+ * Computes the prefix sums of a range of terms, starting
+ * from the given running sum.
+ *
+ * @tparam method the method of accumulating the sums
+ * @param in the terms
+ * @param out the prefix sums
+ * @param begin the index of the first term
+ * @param end the index past the last term
+ * @param acc the sum of the terms preceding the range
+ */
+template<summation method>
+static void scan(const double *in, double *out, size_t begin, size_t end, running_sum acc) {
+    for (size_t i = begin; i < end; ++i) {
+        accumulate<method>(acc, in[i]);
+        out[i] = acc.sum;
+    }
+}
+
+/**
+ * Computes the prefix sums of the given terms in parallel
+ * chunks.
+ *
+ * @tparam method the method of accumulating the sums
+ * @param in the terms
+ * @param out the prefix sums
+ * @param len the number of terms
+ * @param chunks the number of chunks
+ */
+template<summation method>
+static void prefix_sum_chunked(const double *in, double *out, size_t len, size_t chunks) {
+    if (chunks == 1) {
+        scan<method>(in, out, 0, len, {});
+        return;
+    }
+
+    std::vector<size_t> bounds(chunks + 1);
+    for (size_t c = 0; c <= chunks; ++c) {
+        bounds[c] = len * c / chunks;
+    }
+
+    // First pass: sum each chunk except the last, whose
+    // total no chunk needs, keeping the first for the
+    // calling thread
+    std::vector<running_sum> totals(chunks);
+    std::vector<std::future<void>> tasks;
+    for (size_t c = 1; c + 1 < chunks; ++c) {
+        tasks.push_back(std::async(std::launch::async, [&, c]() {
+            totals[c] = reduce<method>(in, bounds[c], bounds[c + 1]);
+        }));
+    }
+    totals[0] = reduce<method>(in, bounds[0], bounds[1]);
+    for (auto &task : tasks) {
+        task.get();
+    }
+    tasks.clear();
+
+    // Accumulate the totals into the offset of each chunk,
+    // carrying both compensations
+    std::vector<running_sum> offsets(chunks);
+    for (size_t c = 1; c < chunks; ++c) {
+        running_sum acc = offsets[c - 1];
+        accumulate<method>(acc, totals[c - 1].sum);
+        accumulate<method>(acc, -totals[c - 1].compensation);
+        offsets[c] = acc;
+    }
+
+    // Second pass: scan each chunk from its offset
+    for (size_t c = 1; c < chunks; ++c) {
+        tasks.push_back(std::async(std::launch::async, [&, c]() {
+            scan<method>(in, out, bounds[c], bounds[c + 1], offsets[c]);
+        }));
+    }
+    scan<method>(in, out, bounds[0], bounds[1], offsets[0]);
+    for (auto &task : tasks) {
+        task.get();
+    }
+}
+
+void prefix_sum(array_view<const double> in, array_view<double> out, summation method, unsigned int threads) {
+    size_t len = in.size();
+    if (len == 0) {
+        return;
+    }
+
+    if (threads == 0) {
+        threads = std::max(1U, std::thread::hardware_concurrency());
+    }
+    size_t chunks = std::min<size_t>(threads, len / MIN_CHUNK_SIZE + 1);
+
+    if (method == summation::compensated) {
+        prefix_sum_chunked<summation::compensated>(in.data(), out.data(), len, chunks);
+    } else {
+        prefix_sum_chunked<summation::plain>(in.data(), out.data(), len, chunks);
+    }
+}
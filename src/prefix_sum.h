@@ -0,0 +1,52 @@
+/**
+ * @file
+ */
+
+#ifndef TELEM_FILTER_PREFIX_SUM_H
+#define TELEM_FILTER_PREFIX_SUM_H
+
+#include "array_view.h"
+
+/**
+ * @brief The methods of accumulating floating point sums.
+ */
+enum class summation {
+    /**
+     * Adding each term to the running sum, whose rounding
+     * error grows with the number of terms.
+     */
+    plain,
+    /**
+     * Kahan compensated summation, which carries the
+     * rounding error of the running sum into the next term,
+     * so the error stays near that of a single addition at
+     * about four times the cost per term.
+     */
+    compensated
+};
+
+/**
+ * Computes the inclusive prefix sums of the given terms, so
+ * that each output is the sum of the terms up to and
+ * including the one at the same index.
+ *
+ * The terms are split into one chunk per thread. Each chunk
+ * is summed in parallel, the chunk totals are accumulated
+ * into the offset of each chunk, then each chunk is scanned
+ * from its offset in parallel. The sums may differ from a
+ * serial scan by rounding error, which compensation keeps to
+ * about that of a single addition.
+ *
+ * @param in the terms
+ * @param out the prefix sums, which must have the same
+ * length as the terms and may be the same array
+ * @param method the method of accumulating the sums
+ * @param threads the number of threads to use, or 0 to use
+ * one thread per hardware core
+ */
+void prefix_sum(array_view<const double> in,
+                array_view<double> out,
+                summation method = summation::plain,
+                unsigned int threads = 1);
+
+#endif // TELEM_FILTER_PREFIX_SUM_H
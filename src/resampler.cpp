@@ -0,0 +1,151 @@
+#include "resampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+/**
+ * The fraction of a grid period by which the last sample
+ * may fall short of a grid point and still count as one,
+ * so that rounding in the sample times does not drop it.
+ */
+static const double GRID_TOLERANCE = 1e-9;
+
+uniform_resampler::uniform_resampler(array_view<const double> times, double rate, interpolation method) :
+        method(method) {
+    size_t len = times.size();
+    if (len < 2) {
+        throw std::invalid_argument{"Resampling requires at least two samples."};
+    }
+    if (!(rate > 0)) {
+        throw std::invalid_argument{"Resampling rate must be positive."};
+    }
+    for (size_t j = 1; j < len; ++j) {
+        if (!(times[j] > times[j - 1])) {
+            throw std::invalid_argument{"Resampling requires strictly ascending sample times."};
+        }
+    }
+
+    start = times[0];
+    period = 1 / rate;
+    source_len = len;
+
+    size_t grid_len = static_cast<size_t>(std::floor((times[len - 1] - start) * rate + GRID_TOLERANCE)) + 1;
+    segments.resize(grid_len);
+    w_left.resize(grid_len);
+    w_right.resize(grid_len);
+    if (method == interpolation::cubic) {
+        w_left_slope.resize(grid_len);
+        w_right_slope.resize(grid_len);
+    }
+
+    // Both the grid and the sample times ascend, so the
+    // segment of each grid point is found by merging them
+    size_t j = 0;
+    for (size_t i = 0; i < grid_len; ++i) {
+        double t = start + static_cast<double>(i) * period;
+        while (j + 2 < len && times[j + 1] <= t) {
+            ++j;
+        }
+
+        double h = times[j + 1] - times[j];
+        double u = std::min((t - times[j]) / h, 1.0);
+        segments[i] = j;
+
+        if (method == interpolation::linear) {
+            w_left[i] = 1 - u;
+            w_right[i] = u;
+        } else {
+            // Cubic Hermite basis functions, with the slope
+            // terms scaled by the segment length
+            double u2 = u * u;
+            double u3 = u2 * u;
+            w_left[i] = 2 * u3 - 3 * u2 + 1;
+            w_right[i] = -2 * u3 + 3 * u2;
+            w_left_slope[i] = (u3 - 2 * u2 + u) * h;
+            w_right_slope[i] = (u3 - u2) * h;
+        }
+    }
+
+    if (method == interpolation::cubic) {
+        // The end samples only have one neighbor, so their
+        // slopes are those of the adjacent segments
+        inv_spans.resize(len);
+        inv_spans[0] = 1 / (times[1] - times[0]);
+        for (size_t k = 1; k + 1 < len; ++k) {
+            inv_spans[k] = 1 / (times[k + 1] - times[k - 1]);
+        }
+        inv_spans[len - 1] = 1 / (times[len - 1] - times[len - 2]);
+    }
+}
+
+size_t uniform_resampler::size() const {
+    return segments.size();
+}
+
+double uniform_resampler::get_start() const {
+    return start;
+}
+
+double uniform_resampler::get_period() const {
+    return period;
+}
+
+void uniform_resampler::resample(array_view<const double> values, array_view<double> out) const {
+    if (values.size() != source_len) {
+        throw std::invalid_argument{"Signal does not match the sample times."};
+    }
+    if (out.size() != segments.size()) {
+        throw std::invalid_argument{"Output does not match the grid."};
+    }
+
+    size_t grid_len = segments.size();
+    const size_t *seg = segments.data();
+    const double *v = values.data();
+    double *y = out.data();
+
+    if (method == interpolation::linear) {
+        const double *wl = w_left.data();
+        const double *wr = w_right.data();
+        for (size_t i = 0; i < grid_len; ++i) {
+            size_t j = seg[i];
+            y[i] = wl[i] * v[j] + wr[i] * v[j + 1];
+        }
+
+        return;
+    }
+
+    // Estimate the slope at every sample from its neighbors
+    std::vector<double> slopes(source_len);
+    slopes[0] = (v[1] - v[0]) * inv_spans[0];
+    for (size_t k = 1; k + 1 < source_len; ++k) {
+        slopes[k] = (v[k + 1] - v[k - 1]) * inv_spans[k];
+    }
+    slopes[source_len - 1] = (v[source_len - 1] - v[source_len - 2]) * inv_spans[source_len - 1];
+
+    const double *m = slopes.data();
+    const double *wl = w_left.data();
+    const double *wr = w_right.data();
+    const double *wml = w_left_slope.data();
+    const double *wmr = w_right_slope.data();
+    for (size_t i = 0; i < grid_len; ++i) {
+        size_t j = seg[i];
+        y[i] = wl[i] * v[j] + wr[i] * v[j + 1] + wml[i] * m[j] + wmr[i] * m[j + 1];
+    }
+}
+
+std::vector<double> uniform_resampler::resample(array_view<const double> values) const {
+    std::vector<double> out(size());
+    resample(values, out);
+
+    return out;
+}
+
+telem_data uniform_resampler::resample(const telem_data &data, double rate, interpolation method) {
+    uniform_resampler resampler{data.get_times(), rate, method};
+
+    return {resampler.get_start(),
+            resampler.get_period(),
+            resampler.resample(data.get_velocities()),
+            resampler.resample(data.get_altitudes())};
+}
@@ -0,0 +1,162 @@
+/**
+ * @file
+ */
+
+#ifndef TELEM_FILTER_RESAMPLER_H
+#define TELEM_FILTER_RESAMPLER_H
+
+#include <vector>
+
+#include "array_view.h"
+#include "telem_data.h"
+
+/**
+ * @brief The methods of interpolating between samples.
+ */
+enum class interpolation {
+    /**
+     * Straight lines between neighboring samples.
+     */
+    linear,
+    /**
+     * Cubic Hermite splines whose slope at each sample is
+     * that of the line through its neighbors, which are
+     * smooth but may overshoot abrupt changes.
+     */
+    cubic
+};
+
+/**
+ * @brief Interpolates signals sampled at irregular times
+ * onto a uniform time grid.
+ *
+ * The grid starts at the first sample time and ends at or
+ * before the last. Locating the grid times among the sample
+ * times and computing the interpolation weights is done
+ * once, in a single merge pass, and shared by every signal
+ * sampled at the same times. Each signal is then resampled
+ * in one pass over contiguous arrays, summing the weighted
+ * neighboring samples of every grid time.
+ */
+class uniform_resampler {
+private:
+    /**
+     * The method of interpolation.
+     */
+    interpolation method;
+    /**
+     * The time of the first grid point.
+     */
+    double start;
+    /**
+     * The time between consecutive grid points.
+     */
+    double period;
+    /**
+     * The number of samples at the original times.
+     */
+    size_t source_len;
+
+    /**
+     * The index of the sample preceding each grid point,
+     * whose interval to the next sample contains it.
+     */
+    std::vector<size_t> segments;
+    /**
+     * The weight of the sample preceding each grid point.
+     */
+    std::vector<double> w_left;
+    /**
+     * The weight of the sample following each grid point.
+     */
+    std::vector<double> w_right;
+    /**
+     * The weight of the slope at the preceding sample, used
+     * by cubic interpolation.
+     */
+    std::vector<double> w_left_slope;
+    /**
+     * The weight of the slope at the following sample, used
+     * by cubic interpolation.
+     */
+    std::vector<double> w_right_slope;
+    /**
+     * The reciprocal of the time spanned by the neighbors of
+     * each sample, used to estimate the slopes of cubic
+     * interpolation.
+     */
+    std::vector<double> inv_spans;
+
+public:
+    /**
+     * Creates a new resampler from the given sample times
+     * onto a grid with the given sample rate.
+     *
+     * @param times the sample times, in strictly ascending
+     * order
+     * @param rate the sample rate of the grid
+     * @param method the method of interpolation
+     * @throws std::invalid_argument if there are fewer than
+     * two samples, the times are not strictly ascending or
+     * the rate is not positive
+     */
+    uniform_resampler(array_view<const double> times, double rate, interpolation method);
+
+    /**
+     * Obtains the number of grid points.
+     *
+     * @return the length of the resampled signals
+     */
+    [[nodiscard]] size_t size() const;
+
+    /**
+     * Obtains the time of the first grid point.
+     *
+     * @return the start time
+     */
+    [[nodiscard]] double get_start() const;
+
+    /**
+     * Obtains the time between consecutive grid points.
+     *
+     * @return the grid period
+     */
+    [[nodiscard]] double get_period() const;
+
+    /**
+     * Resamples a signal onto the grid.
+     *
+     * @param values the signal at the original times
+     * @param out the signal at the grid times, which must
+     * hold size() elements
+     * @throws std::invalid_argument if the signal does not
+     * match the original times in length, or the output does
+     * not hold size() elements
+     */
+    void resample(array_view<const double> values, array_view<double> out) const;
+
+    /**
+     * Resamples a signal onto the grid.
+     *
+     * @param values the signal at the original times
+     * @return the signal at the grid times
+     * @throws std::invalid_argument if the signal does not
+     * match the original times in length
+     */
+    std::vector<double> resample(array_view<const double> values) const;
+
+    /**
+     * Resamples every channel of the given telemetry data
+     * onto a uniform grid.
+     *
+     * @param data the telemetry data
+     * @param rate the sample rate of the grid
+     * @param method the method of interpolation
+     * @return the telemetry data on the grid
+     * @throws std::invalid_argument if there are fewer than
+     * two samples or the rate is not positive
+     */
+    static telem_data resample(const telem_data &data, double rate, interpolation method);
+};
+
+#endif // TELEM_FILTER_RESAMPLER_H
@@ -0,0 +1,114 @@
+/**
+ * @file
+ */
+
+#ifndef TELEM_FILTER_SIGNAL_FILTER_H
+#define TELEM_FILTER_SIGNAL_FILTER_H
+
+#include <stdexcept>
+#include <vector>
+
+#include "array_view.h"
+
+/**
+ * Determines the common length of several channels of a
+ * multi-channel signal.
+ *
+ * @param signals the channels
+ * @return the length of every channel, or 0 if there are
+ * none
+ * @throws std::invalid_argument if the channels differ in
+ * length
+ */
+inline size_t channel_length(const std::vector<array_view<const double>> &signals) {
+    size_t len = signals.empty() ? 0 : signals[0].size();
+    for (const array_view<const double> &signal : signals) {
+        if (signal.size() != len) {
+            throw std::invalid_argument{"Channels must have the same length."};
+        }
+    }
+
+    return len;
+}
+
+/**
+ * @brief The interface shared by the filters which map each
+ * input sample to one output sample, so that one filter
+ * design can be swapped for another.
+ *
+ * A filter transforms whole signals from rest, or acts as a
+ * stateful stream processor which is fed samples one at a
+ * time or in blocks of any size.
+ */
+class signal_filter {
+public:
+    virtual ~signal_filter() = default;
+
+    /**
+     * Performs a 1-D transformation of the given signal by
+     * the filter transfer function.
+     *
+     * The transformation starts from rest and does not use
+     * or modify the streaming state of this filter.
+     *
+     * @param signal the signal to transform
+     * @return the resulting signal
+     */
+    virtual std::vector<double> transform(array_view<const double> signal) const = 0;
+
+    /**
+     * Performs the transformation of transform() on each
+     * channel of a multi-channel signal, such as the X and Y
+     * components of a velocity.
+     *
+     * The channels are transformed one at a time unless the
+     * filter can filter them together in a single pass.
+     *
+     * @param signals the channels to transform, which must
+     * have the same length
+     * @return the resulting channels, in the same order
+     * @throws std::invalid_argument if the channels differ
+     * in length
+     */
+    virtual std::vector<std::vector<double>> transform_channels(
+            const std::vector<array_view<const double>> &signals) const;
+
+    /**
+     * Filters the next sample of the stream.
+     *
+     * @param x the input sample
+     * @return the output sample
+     */
+    virtual double process(double x) = 0;
+
+    /**
+     * Filters the next block of samples of the stream,
+     * producing the same output as process() would for
+     * each sample, up to rounding error.
+     *
+     * @param in the input samples
+     * @param out the output samples, which must have the
+     * same length as the input and may be the same array
+     */
+    virtual void process_block(array_view<const double> in, array_view<double> out) = 0;
+
+    /**
+     * Resets the stream to rest.
+     */
+    virtual void reset() = 0;
+};
+
+inline std::vector<std::vector<double>> signal_filter::transform_channels(
+        const std::vector<array_view<const double>> &signals) const {
+    channel_length(signals);
+
+    std::vector<std::vector<double>> results;
+    results.reserve(signals.size());
+    for (const array_view<const double> &signal : signals) {
+        results.push_back(transform(signal));
+    }
+
+    return results;
+}
+
+#endif // TELEM_FILTER_SIGNAL_FILTER_H
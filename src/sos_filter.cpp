@@ -0,0 +1,118 @@
+#include "sos_filter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <stdexcept>
+
+sos_filter::sos_filter(std::vector<biquad> sections) :
+        sections(std::move(sections)),
+        state(2 * this->sections.size(), 0) {
+}
+
+const std::vector<biquad> &sos_filter::get_sections() const {
+    return sections;
+}
+
+std::vector<double> sos_filter::transform(array_view<const double> signal) const {
+    std::vector<double> result(signal.size());
+
+    sos_filter stream{*this};
+    stream.reset();
+    stream.process_block(signal, result);
+
+    return result;
+}
+
+double sos_filter::process(double x) {
+    double *z = state.data();
+    for (const biquad &s : sections) {
+        double y = s.b0 * x + z[0];
+        z[0] = s.b1 * x - s.a1 * y + z[1];
+        z[1] = s.b2 * x - s.a2 * y;
+
+        x = y;
+        z += 2;
+    }
+
+    return x;
+}
+
+void sos_filter::process_block(array_view<const double> in, array_view<double> out) {
+    size_t len = in.size();
+    if (in.data() != out.data()) {
+        std::copy(in.begin(), in.end(), out.begin());
+    }
+
+    // Run each section over the whole block in place
+    double *z = state.data();
+    for (const biquad &s : sections) {
+        double z0 = z[0];
+        double z1 = z[1];
+        for (size_t i = 0; i < len; ++i) {
+            double x = out[i];
+            double y = s.b0 * x + z0;
+            z0 = s.b1 * x - s.a1 * y + z1;
+            z1 = s.b2 * x - s.a2 * y;
+
+            out[i] = y;
+        }
+
+        z[0] = z0;
+        z[1] = z1;
+        z += 2;
+    }
+}
+
+void sos_filter::reset() {
+    std::fill(state.begin(), state.end(), 0);
+}
+
+double sos_filter::dc_group_delay() const {
+    // The group delay of B(z) / A(z) at DC is the centroid
+    // of the numerator minus that of the denominator
+    double delay = 0;
+    for (const biquad &s : sections) {
+        delay += (s.b1 + 2 * s.b2) / (s.b0 + s.b1 + s.b2);
+        delay -= (s.a1 + 2 * s.a2) / (1 + s.a1 + s.a2);
+    }
+
+    return delay;
+}
+
+sos_filter sos_filter::butterworth_lowpass(unsigned int order, double cutoff, double sample_rate) {
+    if (order == 0 || cutoff <= 0 || cutoff >= sample_rate / 2) {
+        throw std::invalid_argument{"Butterworth filter requires a nonzero order and a cutoff below Nyquist."};
+    }
+
+    // Prewarp the cutoff to the analog prototype
+    double k = 2 * sample_rate;
+    double wc = k * std::tan(M_PI * cutoff / sample_rate);
+
+    std::vector<biquad> sections;
+    sections.reserve((order + 1) / 2);
+
+    // Each conjugate pair of analog poles on the left half
+    // of the circle of radius wc becomes one section
+    for (unsigned int i = 0; i < order / 2; ++i) {
+        double theta = M_PI * (2 * i + order + 1) / (2 * order);
+        std::complex<double> pole = std::polar(wc, theta);
+
+        // wc^2 / (s^2 + alpha s + wc^2), with s = k (z - 1) / (z + 1)
+        double alpha = -2 * pole.real();
+        double a0 = k * k + alpha * k + wc * wc;
+        double gain = wc * wc / a0;
+        sections.push_back({gain, 2 * gain, gain,
+                            2 * (wc * wc - k * k) / a0,
+                            (k * k - alpha * k + wc * wc) / a0});
+    }
+
+    // Odd orders have a single real pole at -wc
+    if (order % 2 != 0) {
+        double a0 = k + wc;
+        double gain = wc / a0;
+        sections.push_back({gain, gain, 0, (wc - k) / a0, 0});
+    }
+
+    return sos_filter{std::move(sections)};
+}
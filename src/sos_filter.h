@@ -0,0 +1,146 @@
+/**
+ * @file
+ */
+
+#ifndef TELEM_FILTER_SOS_FILTER_H
+#define TELEM_FILTER_SOS_FILTER_H
+
+#include <vector>
+
+#include "array_view.h"
+#include "signal_filter.h"
+
+/**
+ * @brief The coefficients of a second-order section of an
+ * IIR filter, normalized such that a0 is 1:
+ *
+ *   H(z) = (b0 + b1 z^-1 + b2 z^-2) / (1 + a1 z^-1 + a2 z^-2)
+ */
+struct biquad {
+    /**
+     * Numerator coefficient of z^0.
+     */
+    double b0;
+    /**
+     * Numerator coefficient of z^-1.
+     */
+    double b1;
+    /**
+     * Numerator coefficient of z^-2.
+     */
+    double b2;
+    /**
+     * Denominator coefficient of z^-1.
+     */
+    double a1;
+    /**
+     * Denominator coefficient of z^-2.
+     */
+    double a2;
+};
+
+/**
+ * @brief Represents an IIR filter as a cascade of
+ * second-order sections.
+ *
+ * Each section is evaluated in transposed direct form II,
+ * which needs only two state variables per section and
+ * stays numerically well behaved at high orders, where a
+ * single direct form polynomial would lose precision.
+ *
+ * Like digital_filter, the cascade can transform whole
+ * signals or be used as a stateful stream processor. Blocks
+ * are filtered one section at a time over the whole block,
+ * so the state and coefficients of a section stay in
+ * registers.
+ */
+class sos_filter : public signal_filter {
+private:
+    /**
+     * The sections of the cascade, in order.
+     */
+    std::vector<biquad> sections;
+
+    /**
+     * The two state variables of each section, one section
+     * after another.
+     */
+    std::vector<double> state;
+
+public:
+    /**
+     * Creates a new cascade of the given sections.
+     *
+     * @param sections the second-order sections, applied in
+     * order
+     */
+    explicit sos_filter(std::vector<biquad> sections);
+
+    /**
+     * Obtains the sections of the cascade.
+     *
+     * @return the second-order sections
+     */
+    [[nodiscard]] const std::vector<biquad> &get_sections() const;
+
+    /**
+     * Performs a 1-D transformation of the given signal by
+     * the filter transfer function.
+     *
+     * The transformation starts from rest and does not use
+     * or modify the streaming state of this filter.
+     *
+     * @param signal the signal to transform
+     * @return the resulting signal
+     */
+    std::vector<double> transform(array_view<const double> signal) const override;
+
+    /**
+     * Filters the next sample of the stream.
+     *
+     * @param x the input sample
+     * @return the output sample
+     */
+    double process(double x) override;
+
+    /**
+     * Filters the next block of samples of the stream,
+     * producing the same output as process() would for
+     * each sample.
+     *
+     * @param in the input samples
+     * @param out the output samples, which must have the
+     * same length as the input and may be the same array
+     */
+    void process_block(array_view<const double> in, array_view<double> out) override;
+
+    /**
+     * Resets the stream to rest.
+     */
+    void reset() override;
+
+    /**
+     * Computes the group delay of the filter at DC, which
+     * is the delay of slowly varying signals. The filter
+     * must not block DC.
+     *
+     * @return the group delay, in samples
+     */
+    [[nodiscard]] double dc_group_delay() const;
+
+    /**
+     * Designs a Butterworth low-pass filter using the
+     * bilinear transform, with the cutoff frequency
+     * prewarped so the response is 3 dB down at the cutoff.
+     *
+     * @param order the filter order
+     * @param cutoff the cutoff frequency, Hz
+     * @param sample_rate the sample rate, Hz
+     * @return the filter, with (order + 1) / 2 sections
+     * @throws std::invalid_argument if the order is zero or
+     * the cutoff is not between 0 and the Nyquist frequency
+     */
+    static sos_filter butterworth_lowpass(unsigned int order, double cutoff, double sample_rate);
+};
+
+#endif // TELEM_FILTER_SOS_FILTER_H
@@ -0,0 +1,199 @@
+/**
+ * @file
+ */
+
+#ifndef TELEM_FILTER_SPSC_QUEUE_H
+#define TELEM_FILTER_SPSC_QUEUE_H
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+/**
+ * The assumed size of a cache line, used to keep the
+ * indices written by the producer and by the consumer from
+ * sharing one.
+ */
+static constexpr size_t CACHE_LINE_SIZE = 64;
+
+/**
+ * @brief A bounded lock-free queue passing values from a
+ * single producer thread to a single consumer thread.
+ *
+ * The values are kept in a ring buffer whose capacity is a
+ * power of two. Each index is written by only one side and
+ * published with release semantics, so neither side ever
+ * takes a lock. Each side also caches the last index it
+ * read from the other, so it only touches the other side's
+ * cache line when the queue appears full or empty.
+ *
+ * The producer closes the queue once it has pushed its last
+ * value, after which the consumer drains the remaining
+ * values and is then told the stream has ended.
+ *
+ * @tparam T the type of the values, which must be default
+ * constructible
+ */
+template<typename T>
+class spsc_queue {
+private:
+    /**
+     * The ring buffer of values.
+     */
+    std::vector<T> slots;
+    /**
+     * The capacity minus one, masking a position into an
+     * index of the ring buffer.
+     */
+    size_t mask;
+
+    /**
+     * The number of values pushed, written by the producer.
+     */
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail{0};
+    /**
+     * The number of values popped as last seen by the
+     * producer.
+     */
+    size_t cached_head{0};
+    /**
+     * Whether the producer has pushed its last value.
+     */
+    std::atomic<bool> closed{false};
+
+    /**
+     * The number of values popped, written by the consumer.
+     */
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head{0};
+    /**
+     * The number of values pushed as last seen by the
+     * consumer.
+     */
+    size_t cached_tail{0};
+
+public:
+    /**
+     * Creates a new empty queue.
+     *
+     * @param capacity the maximum number of values held at
+     * once, which must be a power of two
+     * @throws std::invalid_argument if the capacity is not a
+     * power of two
+     */
+    explicit spsc_queue(size_t capacity);
+
+    /**
+     * Pushes a value if there is room for it. Must only be
+     * called by the producer.
+     *
+     * @param value the value to push
+     * @return true if the value was pushed, false if the
+     * queue is full
+     */
+    bool try_push(const T &value);
+
+    /**
+     * Pushes a value, waiting for room if the queue is full.
+     * Must only be called by the producer.
+     *
+     * @param value the value to push
+     */
+    void push(const T &value);
+
+    /**
+     * Marks the end of the stream. Must only be called by
+     * the producer, after its last push.
+     */
+    void close();
+
+    /**
+     * Pops the oldest value if there is one. Must only be
+     * called by the consumer.
+     *
+     * @param value set to the value popped
+     * @return true if a value was popped, false if the queue
+     * is empty
+     */
+    bool try_pop(T &value);
+
+    /**
+     * Pops the oldest value, waiting for one if the queue is
+     * empty. Must only be called by the consumer.
+     *
+     * @param value set to the value popped
+     * @return true if a value was popped, false if the queue
+     * is empty and closed
+     */
+    bool pop(T &value);
+};
+
+template<typename T>
+spsc_queue<T>::spsc_queue(size_t capacity) :
+        slots(capacity),
+        mask(capacity - 1) {
+    if (capacity == 0 || (capacity & mask) != 0) {
+        throw std::invalid_argument{"Queue capacity must be a power of two."};
+    }
+}
+
+template<typename T>
+bool spsc_queue<T>::try_push(const T &value) {
+    size_t t = tail.load(std::memory_order_relaxed);
+    if (t - cached_head == slots.size()) {
+        cached_head = head.load(std::memory_order_acquire);
+        if (t - cached_head == slots.size()) {
+            return false;
+        }
+    }
+
+    slots[t & mask] = value;
+    tail.store(t + 1, std::memory_order_release);
+
+    return true;
+}
+
+template<typename T>
+void spsc_queue<T>::push(const T &value) {
+    while (!try_push(value)) {
+        std::this_thread::yield();
+    }
+}
+
+template<typename T>
+void spsc_queue<T>::close() {
+    closed.store(true, std::memory_order_release);
+}
+
+template<typename T>
+bool spsc_queue<T>::try_pop(T &value) {
+    size_t h = head.load(std::memory_order_relaxed);
+    if (h == cached_tail) {
+        cached_tail = tail.load(std::memory_order_acquire);
+        if (h == cached_tail) {
+            return false;
+        }
+    }
+
+    value = slots[h & mask];
+    head.store(h + 1, std::memory_order_release);
+
+    return true;
+}
+
+template<typename T>
+bool spsc_queue<T>::pop(T &value) {
+    while (!try_pop(value)) {
+        // Values pushed before the queue was closed are still
+        // popped, so check once more after seeing it closed
+        if (closed.load(std::memory_order_acquire)) {
+            return try_pop(value);
+        }
+
+        std::this_thread::yield();
+    }
+
+    return true;
+}
+
+#endif // TELEM_FILTER_SPSC_QUEUE_H
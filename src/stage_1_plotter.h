@@ -5,22 +5,29 @@
 #ifndef TELEM_FILTER_STAGE_1_PLOTTER_H
 #define TELEM_FILTER_STAGE_1_PLOTTER_H
 
-#include "telem_data_json.h"
 #include "staged_telem_plotter.h"
+#include "telem_data.h"
+#include "telem_pipeline.h"
 
 /**
  * @brief Performs stage 1 of data processing and plots the
  * results.
  *
  * Stage 1 consists of linear interpolation of altitude
- * data and initial velocity component extraction.
+ * data, optional resampling onto a uniform time grid and
+ * initial velocity component extraction.
  */
 class stage_1_plotter : public staged_telem_plotter<first_stage_plotter> {
 private:
     /**
      * The raw parsed telemetry data.
      */
-    const telem_data_json &raw_data;
+    const telem_data &raw_data;
+
+    /**
+     * The time grid on which the telemetry is processed.
+     */
+    stage_1_grid grid;
 
     /**
      * The processed telemetry data used to produce the
@@ -34,14 +41,17 @@ public:
      * parameter(s).
      *
      * @param raw_data the raw telemetry data to process
+     * @param grid the time grid on which to process the
+     * telemetry
      */
-    explicit stage_1_plotter(const telem_data_json &raw_data);
+    explicit stage_1_plotter(const telem_data &raw_data, stage_1_grid grid = stage_1_grid::raw);
 
     /**
      * Obtains the processed raw telemetry data from this
      * stage that was used to produce the result.
      *
-     * Not valid until join() returns.
+     * Not valid until join() returns or the first velocity
+     * is popped from the stream of this stage.
      *
      * @return the processed telemetry data
      */
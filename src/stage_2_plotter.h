@@ -6,35 +6,75 @@
 #define TELEM_FILTER_STAGE_2_PLOTTER_H
 
 #include "stage_1_plotter.h"
+#include "telem_pipeline.h"
 
 /**
  * @brief Stage 2 of telemetry processing and plotting.
  *
  * This stage transforms the velocities from stage 1 using a
- * Parks-McClellan low-pass filter.
+ * 1 Hz low-pass filter.
  */
 class stage_2_plotter : public staged_telem_plotter<stage_1_plotter> {
 private:
+    /**
+     * The low-pass filter design to use.
+     */
+    stage_2_lpf lpf_type;
+
+    /**
+     * The stream of velocities from stage 1, if this stage
+     * is streaming.
+     */
+    spsc_queue<velocity_sample> *input{nullptr};
+
     /**
      * The processed telemetry data used to produce the
      * adjusted velocities from stage 1.
      */
     const telem_data &processed_data;
 
+    /**
+     * Filters and plots the velocities of stage 1 as they
+     * are streamed, so that each filtered velocity is
+     * available once the filter delay has passed rather
+     * than once stage 1 has finished.
+     */
+    void calc_stream();
+
+    /**
+     * Records the filtered velocity at the given index of
+     * the result to the data matrix and updates the plot.
+     *
+     * @param i the index of the velocity
+     * @param v_filtered the filtered velocity
+     * @param v_y_f_integral the altitude from integrating
+     * the filtered velocities up to this one, km
+     */
+    void plot(int i, const vector2d &v_filtered, double v_y_f_integral);
+
 public:
     /**
      * Creates a new stage 2 data processor/plotter using
      * the data from the first stage.
      *
      * @param prior_stage the first stage data
+     * @param lpf_type the low-pass filter design to use
+     * @param mode how the velocities of the first stage are
+     * obtained
+     * @throws std::invalid_argument if the filter is
+     * zero-phase and the mode is streaming, as zero-phase
+     * filtering requires the whole flight up front
      */
-    explicit stage_2_plotter(stage_1_plotter &prior_stage);
+    explicit stage_2_plotter(stage_1_plotter &prior_stage,
+                             stage_2_lpf lpf_type = stage_2_lpf::parks_mcclellan,
+                             pipeline_mode mode = pipeline_mode::batch);
 
     /**
      * Obtains the processed raw telemetry data from stage
      * that was used to produce the first stage result.
      *
-     * Not valid until join() returns.
+     * Not valid until join() returns or the first velocity
+     * is popped from the stream of this stage.
      *
      * @return the processed telemetry data
      */
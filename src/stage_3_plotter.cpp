@@ -1,10 +1,15 @@
 #include "stage_3_plotter.h"
 
-stage_3_plotter::stage_3_plotter(stage_2_plotter &prior_stage) :
-        staged_telem_plotter<stage_2_plotter>(prior_stage) {
+template<typename prior_stage_type>
+stage_3_plotter<prior_stage_type>::stage_3_plotter(prior_stage_type &prior_stage, pipeline_mode mode) :
+        staged_telem_plotter<prior_stage_type>(prior_stage) {
+    if (mode == pipeline_mode::streaming) {
+        input = &prior_stage.open_stream();
+    }
 }
 
-void stage_3_plotter::plotter_draw(mglGraph *gr) {
+template<typename prior_stage_type>
+void stage_3_plotter<prior_stage_type>::plotter_draw(mglGraph *gr) {
     std::scoped_lock<std::mutex> lock{data_mutex};
 
     gr->Clf();
@@ -50,69 +55,63 @@ void stage_3_plotter::plotter_draw(mglGraph *gr) {
     gr->Plot(data.SubData(0), data.SubData(4));
 }
 
-void stage_3_plotter::plotter_calc() {
-    data.Create(5, 1);
-
-    // Collect data from prior stage
-    prior_stage.join();
-    const std::map<double, vector2d> &v_stage_2 = prior_stage.get_result();
-
+template<typename prior_stage_type>
+void stage_3_plotter<prior_stage_type>::adjust(int i, double v_y_f, double v_y_a_integral) {
     const telem_data &processed_data = prior_stage.get_processed_data();
-    const std::map<double, double> &velocities = processed_data.get_velocities();
-    const std::map<double, double> &altitudes = processed_data.get_altitudes();
-
-    // Adjustment loop
-    auto v_it = velocities.cbegin();
-    auto alt_it = altitudes.cbegin();
-    auto v_f_it = v_stage_2.cbegin();
-
-    double last_t = 0;
-    double v_y_a_integral = 0;
+    double t = processed_data.get_times()[i];
+    double v = processed_data.get_velocities()[i];
+    double alt = processed_data.get_altitudes()[i];
 
-    int time_steps = v_stage_2.size();
-    for (int i = 0; i < time_steps; ++i, ++v_it, ++alt_it, ++v_f_it) {
-        double t = v_it->first;
-        double v = v_it->second;
-        double alt = alt_it->second;
-        const vector2d &v_f = v_f_it->second;
+    vector2d v_adjusted = adjust_velocity(v, v_y_f);
+    result.push_back(t, v_adjusted);
+    emit({t, v_adjusted});
 
-        // Adjust v_x
-        double v_sq = v * v;
-        double v_y_f = v_f.get_y();
-        double v_x_adjusted = std::sqrt(v_sq - std::min(v_y_f * v_y_f, v_sq));
+    plot_row(i, t, v_adjusted, v_adjusted.mag() - v, v_y_a_integral - alt);
+}
 
-        vector2d v_adjusted{v_x_adjusted, v_y_f};
-        result[t] = v_adjusted;
+template<typename prior_stage_type>
+void stage_3_plotter<prior_stage_type>::plotter_calc() {
+    data.Create(5, 1);
 
-        double dt = t - last_t;
-        last_t = t;
+    if (input) {
+        // Adjust each velocity as soon as it is streamed, as
+        // the prior stage completes its processed data before
+        // emitting the first one
+        double v_y_a_integral = 0;
+
+        velocity_sample frame;
+        for (int i = 0; input->pop(frame); ++i) {
+            const telem_data &processed_data = prior_stage.get_processed_data();
+            if (i == 0) {
+                result.reserve(processed_data.size());
+            }
 
-        v_y_a_integral += v_y_f * dt / 1000;
+            double v_y_f = frame.velocity.get_y();
+            v_y_a_integral += v_y_f * processed_data.time_step(i) / 1000;
 
-        // Record data to the matrix
-        {
-            std::scoped_lock<std::mutex> lock{data_mutex};
+            adjust(i, v_y_f, v_y_a_integral);
+        }
 
-            // Expand the data matrix for new data
-            if (i != 0) {
-                data.Insert('y', i);
-            }
+        return;
+    }
 
-            // 0: Time
-            data.Put(t, 0, i);
+    // Collect data from prior stage
+    prior_stage.join();
+    const telem_data &processed_data = prior_stage.get_processed_data();
+    stage_result stage = process_stage_3(prior_stage.get_result(), processed_data);
+    result = std::move(stage.velocities);
 
-            // 1: Velocity X
-            data.Put(v_adjusted.get_x(), 1, i);
-            // 2: Velocity Y
-            data.Put(v_adjusted.get_y(), 2, i);
+    // Plotting loop
+    array_view<const double> times = processed_data.get_times();
 
-            // 3: Velocity Error
-            data.Put(v_adjusted.mag() - v, 3, i);
-            // 4: Altitude Error
-            data.Put(v_y_a_integral - alt, 4, i);
-        }
+    int time_steps = result.size();
+    for (int i = 0; i < time_steps; ++i) {
+        vector2d v_adjusted = result.get(i);
+        emit({times[i], v_adjusted});
 
-        Check();
-        plotter_update();
+        plot_row(i, times[i], v_adjusted, stage.velocity_errors[i], stage.altitude_errors[i]);
     }
 }
+
+template class stage_3_plotter<stage_2_plotter>;
+template class stage_3_plotter<decimation_plotter>;
@@ -5,6 +5,7 @@
 #ifndef TELEM_FILTER_STAGE_3_PLOTTER_H
 #define TELEM_FILTER_STAGE_3_PLOTTER_H
 
+#include "decimation_plotter.h"
 #include "stage_2_plotter.h"
 
 /**
@@ -12,20 +13,63 @@
  *
  * This stage adjusts the data from stage 2 to account for
  * velocity error.
+ *
+ * The stage is instantiated for stage_2_plotter and for
+ * decimation_plotter, which provides the stage 2 data at a
+ * reduced rate.
+ *
+ * @tparam prior_stage_type the type of the stage providing
+ * the filtered velocities and processed telemetry data
  */
-class stage_3_plotter : public staged_telem_plotter<stage_2_plotter> {
+template<typename prior_stage_type>
+class stage_3_plotter : public staged_telem_plotter<prior_stage_type> {
+protected:
+    using staged_telem_plotter<prior_stage_type>::data;
+    using staged_telem_plotter<prior_stage_type>::data_mutex;
+    using staged_telem_plotter<prior_stage_type>::prior_stage;
+    using staged_telem_plotter<prior_stage_type>::result;
+    using staged_telem_plotter<prior_stage_type>::emit;
+    using staged_telem_plotter<prior_stage_type>::plot_row;
+
+private:
+    /**
+     * The stream of velocities from the prior stage, if this
+     * stage is streaming.
+     */
+    spsc_queue<velocity_sample> *input{nullptr};
+
+    /**
+     * Adjusts the filtered velocity at the given index of
+     * the result, appends it to the result and updates the
+     * plot.
+     *
+     * @param i the index of the velocity
+     * @param v_y_f the filtered Y component of the velocity
+     * @param v_y_a_integral the altitude from integrating
+     * the adjusted velocities up to this one, km
+     */
+    void adjust(int i, double v_y_f, double v_y_a_integral);
+
 public:
+    using staged_telem_plotter<prior_stage_type>::Check;
+    using staged_telem_plotter<prior_stage_type>::plotter_update;
+
     /**
      * Creates a new processor/plotter stage with the data
      * from stage 2 of the processing.
      *
      * @param prior_stage the stage 2 processor data
+     * @param mode how the velocities of the prior stage are
+     * obtained
      */
-    explicit stage_3_plotter(stage_2_plotter &prior_stage);
+    explicit stage_3_plotter(prior_stage_type &prior_stage, pipeline_mode mode = pipeline_mode::batch);
 
     void plotter_draw(mglGraph *gr) override;
 
     void plotter_calc() override;
 };
 
+extern template class stage_3_plotter<stage_2_plotter>;
+extern template class stage_3_plotter<decimation_plotter>;
+
 #endif // TELEM_FILTER_STAGE_3_PLOTTER_H
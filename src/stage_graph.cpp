@@ -0,0 +1,86 @@
+#include "stage_graph.h"
+
+stage_graph::run_state::run_state(thread_pool &pool, size_t remaining) :
+        pool(pool),
+        remaining(remaining) {
+}
+
+size_t stage_graph::add_node(std::function<void()> task, const std::vector<size_t> &dependencies) {
+    size_t index = nodes.size();
+
+    auto node = std::make_unique<node_state>();
+    node->task = std::move(task);
+    node->dependency_count = dependencies.size();
+    for (size_t dependency : dependencies) {
+        nodes[dependency]->dependents.push_back(index);
+    }
+    nodes.push_back(std::move(node));
+
+    return index;
+}
+
+size_t stage_graph::size() const {
+    return nodes.size();
+}
+
+void stage_graph::execute(size_t index, run_state &state) {
+    node_state &node = *nodes[index];
+
+    // The remaining nodes are skipped, but still counted
+    // down so that the run finishes
+    if (!state.failed.load(std::memory_order_relaxed)) {
+        try {
+            node.task();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock{state.mutex};
+            if (!state.error) {
+                state.error = std::current_exception();
+            }
+            state.failed.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    // The last input to finish submits the dependent node,
+    // and the acquire-release ordering publishes every
+    // input to it
+    for (size_t dependent : node.dependents) {
+        if (nodes[dependent]->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            state.pool.submit([this, dependent, &state]() {
+                execute(dependent, state);
+            });
+        }
+    }
+
+    std::lock_guard<std::mutex> lock{state.mutex};
+    if (--state.remaining == 0) {
+        state.done.notify_all();
+    }
+}
+
+void stage_graph::run(thread_pool &pool) {
+    if (nodes.empty()) {
+        return;
+    }
+
+    run_state state{pool, nodes.size()};
+    for (const std::unique_ptr<node_state> &node : nodes) {
+        node->pending.store(node->dependency_count, std::memory_order_relaxed);
+    }
+
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        if (nodes[i]->dependency_count == 0) {
+            pool.submit([this, i, &state]() {
+                execute(i, state);
+            });
+        }
+    }
+
+    std::unique_lock<std::mutex> lock{state.mutex};
+    state.done.wait(lock, [&state]() {
+        return state.remaining == 0;
+    });
+
+    if (state.error) {
+        std::rethrow_exception(state.error);
+    }
+}
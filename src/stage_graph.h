@@ -0,0 +1,268 @@
+/**
+ * @file
+ */
+
+#ifndef TELEM_FILTER_STAGE_GRAPH_H
+#define TELEM_FILTER_STAGE_GRAPH_H
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "thread_pool.h"
+
+class stage_graph;
+
+/**
+ * @brief A handle to the value produced by a node of a
+ * stage graph, which is used to declare it as the input of
+ * further nodes and to obtain it once the graph has run.
+ *
+ * Handles are cheap to copy and share the value.
+ *
+ * @tparam T the type of the value
+ */
+template<typename T>
+class stage_output {
+private:
+    friend class stage_graph;
+
+    /**
+     * The graph containing the producing node.
+     */
+    const stage_graph *graph;
+    /**
+     * The index of the producing node in the graph.
+     */
+    size_t node;
+    /**
+     * The value, which is empty until the node has run.
+     */
+    std::shared_ptr<std::optional<T>> value;
+
+    /**
+     * Creates a handle to the value of the given node.
+     *
+     * @param graph the graph containing the node
+     * @param node the index of the node
+     */
+    stage_output(const stage_graph *graph, size_t node);
+
+public:
+    /**
+     * Obtains the value produced by the node.
+     *
+     * Not valid until the node has run, which is before any
+     * node using it as an input runs and before
+     * stage_graph::run() returns.
+     *
+     * @return the value
+     * @throws std::logic_error if the node has not run
+     */
+    [[nodiscard]] const T &get() const;
+};
+
+/**
+ * @brief A directed acyclic graph of processing stages,
+ * each of which is run as a task on a thread pool once the
+ * stages producing its inputs have finished.
+ *
+ * A node is a function from the values of its inputs to its
+ * output value. Inputs can only be the outputs of nodes
+ * already in the graph, so the graph cannot have cycles.
+ * Nodes with no path between them, such as separate
+ * branches processing the altitudes and velocities, run
+ * concurrently, and any number of graphs can be run on one
+ * pool at the same time.
+ */
+class stage_graph {
+private:
+    /**
+     * @brief A node of the graph.
+     */
+    struct node_state {
+        /**
+         * The function producing the output of the node from
+         * its inputs.
+         */
+        std::function<void()> task;
+        /**
+         * The number of nodes whose outputs are inputs of
+         * this node.
+         */
+        size_t dependency_count{0};
+        /**
+         * The indices of the nodes using the output of this
+         * node as an input.
+         */
+        std::vector<size_t> dependents;
+        /**
+         * The number of inputs not yet produced in the
+         * current run.
+         */
+        std::atomic<size_t> pending{0};
+    };
+
+    /**
+     * @brief The progress of one run of the graph.
+     */
+    struct run_state {
+        /**
+         * The pool running the nodes.
+         */
+        thread_pool &pool;
+        /**
+         * Whether a node has thrown, after which the nodes
+         * not yet started are skipped.
+         */
+        std::atomic<bool> failed{false};
+        /**
+         * The first exception thrown by a node.
+         *
+         * Access to this member is protected by the mutex.
+         */
+        std::exception_ptr error;
+        /**
+         * The number of nodes not yet finished or skipped.
+         *
+         * Access to this member is protected by the mutex.
+         */
+        size_t remaining;
+        /**
+         * The mutex used to protect access to the error and
+         * the remaining count.
+         */
+        std::mutex mutex;
+        /**
+         * The condition variable used to wait for the last
+         * node to finish.
+         */
+        std::condition_variable done;
+
+        /**
+         * Creates the state of a run of the given number of
+         * nodes.
+         *
+         * @param pool the pool running the nodes
+         * @param remaining the number of nodes
+         */
+        run_state(thread_pool &pool, size_t remaining);
+    };
+
+    /**
+     * The nodes, in the order they were added.
+     */
+    std::vector<std::unique_ptr<node_state>> nodes;
+
+    /**
+     * Adds a node to the graph.
+     *
+     * @param task the function producing the output of the
+     * node
+     * @param dependencies the indices of the nodes producing
+     * the inputs of the node
+     * @return the index of the node
+     */
+    size_t add_node(std::function<void()> task, const std::vector<size_t> &dependencies);
+
+    /**
+     * Runs a node on the calling worker, then submits each
+     * dependent node whose inputs have all been produced.
+     *
+     * @param index the index of the node
+     * @param state the progress of the run
+     */
+    void execute(size_t index, run_state &state);
+
+public:
+    stage_graph() = default;
+
+    stage_graph(const stage_graph &) = delete;
+
+    stage_graph &operator=(const stage_graph &) = delete;
+
+    /**
+     * Adds a node computing its output from the outputs of
+     * the given nodes.
+     *
+     * @tparam F the type of the function
+     * @tparam inputs_type the types of the input values
+     * @param fn the function of the node, which is called
+     * with the input values in order and returns the output
+     * value
+     * @param inputs the outputs of the nodes to use as the
+     * inputs, which must belong to this graph
+     * @return the output of the node
+     * @throws std::invalid_argument if an input belongs to
+     * another graph
+     */
+    template<typename F, typename... inputs_type>
+    stage_output<std::invoke_result_t<F &, const inputs_type &...>> add(F fn,
+                                                                       const stage_output<inputs_type> &... inputs);
+
+    /**
+     * Obtains the number of nodes.
+     *
+     * @return the number of nodes in the graph
+     */
+    [[nodiscard]] size_t size() const;
+
+    /**
+     * Runs every node of the graph on the given pool,
+     * blocking until they have finished.
+     *
+     * A graph can be run again, which recomputes every
+     * output, but not by several threads at once. Must not
+     * be called from a task of the same pool, which could
+     * leave no worker free to run the nodes.
+     *
+     * @param pool the pool on which to run the nodes
+     * @throws any exception thrown by a node, after the
+     * nodes already started have finished
+     */
+    void run(thread_pool &pool);
+};
+
+template<typename T>
+stage_output<T>::stage_output(const stage_graph *graph, size_t node) :
+        graph(graph),
+        node(node),
+        value(std::make_shared<std::optional<T>>()) {
+}
+
+template<typename T>
+const T &stage_output<T>::get() const {
+    if (!value->has_value()) {
+        throw std::logic_error{"Stage output has not been produced."};
+    }
+
+    return **value;
+}
+
+template<typename F, typename... inputs_type>
+stage_output<std::invoke_result_t<F &, const inputs_type &...>> stage_graph::add(F fn,
+                                                                                const stage_output<inputs_type> &... inputs) {
+    using output_type = std::invoke_result_t<F &, const inputs_type &...>;
+    static_assert(!std::is_void_v<output_type>, "Stage functions must return their output.");
+
+    if (((inputs.graph != this) || ...)) {
+        throw std::invalid_argument{"Stage input belongs to another graph."};
+    }
+
+    stage_output<output_type> output{this, nodes.size()};
+    std::shared_ptr<std::optional<output_type>> value = output.value;
+    add_node([fn = std::move(fn), value, inputs...]() mutable {
+        value->emplace(fn(inputs.get()...));
+    }, {inputs.node...});
+
+    return output;
+}
+
+#endif // TELEM_FILTER_STAGE_GRAPH_H
@@ -5,10 +5,37 @@
 #ifndef TELEM_FILTER_STAGED_TELEM_PLOTTER_H
 #define TELEM_FILTER_STAGED_TELEM_PLOTTER_H
 
-#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
 
+#include "spsc_queue.h"
 #include "staged_mgl_plotter.h"
 #include "vector2d.h"
+#include "velocity_series.h"
+
+/**
+ * The number of velocities a stream buffers before the
+ * producing stage waits for the consuming stage.
+ */
+static const size_t STREAM_CAPACITY = 1024;
+
+/**
+ * @brief The ways a stage can obtain the velocities of its
+ * prior stage.
+ */
+enum class pipeline_mode {
+    /**
+     * Wait for the prior stage to finish and then process
+     * its whole result.
+     */
+    batch,
+    /**
+     * Process each velocity as soon as the prior stage
+     * emits it, so that the stages run concurrently.
+     */
+    streaming
+};
 
 /**
  * @brief A superclass of plotter stages used for this
@@ -21,10 +48,39 @@ template<typename prior_stage_type>
 class staged_telem_plotter : public staged_mgl_plotter<prior_stage_type> {
 protected:
     /**
-     * Map containing the result of this data processing
-     * stage.
+     * The velocity series resulting from this data
+     * processing stage, which stages should reserve up front
+     * from the length of their input.
      */
-    std::map<double, vector2d> result{};
+    velocity_series result{};
+
+    /**
+     * The stream of result velocities to the next stage, if
+     * that stage is streaming.
+     */
+    std::unique_ptr<spsc_queue<velocity_sample>> stream;
+
+    /**
+     * Passes a velocity appended to the result on to the
+     * next stage, if it is streaming.
+     *
+     * @param sample the velocity
+     */
+    void emit(const velocity_sample &sample);
+
+    /**
+     * Records a row of the plotted data and updates the
+     * plot. The data matrix must have been created with 5
+     * columns.
+     *
+     * @param i the index of the row, which is appended
+     * after the rows before it
+     * @param t the time of the row, s
+     * @param velocity the velocity
+     * @param velocity_error the velocity error, m/s
+     * @param altitude_error the altitude error, km
+     */
+    void plot_row(int i, double t, const vector2d &velocity, double velocity_error, double altitude_error);
 
 public:
     /**
@@ -47,9 +103,32 @@ public:
      *
      * Not valid until join() returns.
      *
-     * @return the result map
+     * @return the view of the result series
+     */
+    [[nodiscard]] velocity_series_view get_result() const;
+
+    /**
+     * Opens the stream through which this stage passes each
+     * result velocity to the next stage as it is appended.
+     *
+     * Must be called before this stage is run, by the only
+     * stage consuming the stream, which must also be run as
+     * this stage waits for it whenever the stream is full.
+     * Any processed data of this stage is complete before
+     * the first velocity is emitted.
+     *
+     * @return the stream, which is closed once this stage
+     * finishes
+     * @throws std::logic_error if the stream is already open
      */
-    [[nodiscard]] const std::map<double, vector2d> &get_result() const;
+    spsc_queue<velocity_sample> &open_stream();
+
+    /**
+     * Calculation function that delegates to the
+     * staged_mgl_plotter and then closes the stream, if it
+     * is open.
+     */
+    void Calc() override;
 };
 
 template<typename prior_stage_type>
@@ -61,8 +140,68 @@ template<typename prior_stage_type>
 staged_telem_plotter<prior_stage_type>::staged_telem_plotter() = default;
 
 template<typename prior_stage_type>
-const std::map<double, vector2d> &staged_telem_plotter<prior_stage_type>::get_result() const {
-    return result;
+void staged_telem_plotter<prior_stage_type>::emit(const velocity_sample &sample) {
+    if (stream) {
+        stream->push(sample);
+    }
+}
+
+template<typename prior_stage_type>
+void staged_telem_plotter<prior_stage_type>::plot_row(int i,
+                                                      double t,
+                                                      const vector2d &velocity,
+                                                      double velocity_error,
+                                                      double altitude_error) {
+    // Record data to the matrix
+    {
+        std::scoped_lock<std::mutex> lock{this->data_mutex};
+
+        // Expand the data matrix for new data
+        if (i != 0) {
+            this->data.Insert('y', i);
+        }
+
+        // 0: Time
+        this->data.Put(t, 0, i);
+
+        // 1: Velocity X
+        this->data.Put(velocity.get_x(), 1, i);
+        // 2: Velocity Y
+        this->data.Put(velocity.get_y(), 2, i);
+
+        // 3: Velocity Error
+        this->data.Put(velocity_error, 3, i);
+        // 4: Altitude Error
+        this->data.Put(altitude_error, 4, i);
+    }
+
+    this->Check();
+    this->plotter_update();
+}
+
+template<typename prior_stage_type>
+velocity_series_view staged_telem_plotter<prior_stage_type>::get_result() const {
+    return result.view();
+}
+
+template<typename prior_stage_type>
+spsc_queue<velocity_sample> &staged_telem_plotter<prior_stage_type>::open_stream() {
+    if (stream) {
+        throw std::logic_error{"Stage stream is already open."};
+    }
+
+    stream = std::make_unique<spsc_queue<velocity_sample>>(STREAM_CAPACITY);
+
+    return *stream;
+}
+
+template<typename prior_stage_type>
+void staged_telem_plotter<prior_stage_type>::Calc() {
+    staged_mgl_plotter<prior_stage_type>::Calc();
+
+    if (stream) {
+        stream->close();
+    }
 }
 
 #endif // TELEM_FILTER_STAGED_TELEM_PLOTTER_H
@@ -0,0 +1,169 @@
+#include "stream_engine.h"
+
+stream_engine::stream_state::stream_state(stream_id id, stage_2_lpf lpf_type) :
+        id(id),
+        pipeline(lpf_type) {
+}
+
+stream_engine::stream_engine(thread_pool &pool, output_handler handler, stage_2_lpf lpf_type) :
+        pool(pool),
+        lpf_type(lpf_type),
+        handler(std::move(handler)) {
+    // Reject a filter which cannot be streamed here, rather
+    // than when the first stream is created
+    unsigned int filter_delay;
+    make_stage_2_stream_lpf(lpf_type, filter_delay);
+}
+
+stream_engine::~stream_engine() {
+    wait();
+}
+
+std::shared_ptr<stream_engine::stream_state> stream_engine::find_stream(stream_id id) {
+    std::scoped_lock<std::mutex> lock{mutex};
+    std::shared_ptr<stream_state> &state = streams[id];
+    if (!state) {
+        state = std::make_shared<stream_state>(id, lpf_type);
+    }
+
+    return state;
+}
+
+void stream_engine::submit(std::shared_ptr<stream_state> state) {
+    {
+        std::scoped_lock<std::mutex> lock{mutex};
+        ++scheduled;
+    }
+
+    pool.submit([this, state = std::move(state)]() {
+        run(state);
+    });
+}
+
+void stream_engine::run(const std::shared_ptr<stream_state> &state) {
+    bool ended;
+    {
+        std::scoped_lock<std::mutex> lock{state->mutex};
+        state->taken.swap(state->queued);
+        ended = state->ended;
+    }
+    state->taken_cv.notify_all();
+
+    for (const telem_sample &sample : state->taken) {
+        state->pipeline.push(sample, state->outputs);
+    }
+    state->taken.clear();
+    if (ended) {
+        state->pipeline.finish(state->outputs);
+    }
+
+    stream_outputs &outputs = state->outputs;
+    if (!outputs.stage_1.empty() || !outputs.stage_2.empty() || !outputs.stage_3.empty()) {
+        handler(state->id, outputs);
+        outputs.stage_1.clear();
+        outputs.stage_2.clear();
+        outputs.stage_3.clear();
+    }
+
+    {
+        std::scoped_lock<std::mutex> lock{state->mutex};
+
+        // Samples pushed, or an end, since the queue was taken
+        // go to the back of the pool rather than being run
+        // now, so that the other streams get their turn
+        if (!state->queued.empty() || state->ended != ended) {
+            pool.submit([this, state]() {
+                run(state);
+            });
+            return;
+        }
+        state->scheduled = false;
+    }
+
+    // The ended stream stays findable until its last task has
+    // finished, so that pushes under its identifier wait
+    // rather than start a new stream alongside it
+    if (ended) {
+        {
+            std::scoped_lock<std::mutex> lock{mutex};
+            streams.erase(state->id);
+        }
+
+        std::scoped_lock<std::mutex> lock{state->mutex};
+        state->finished = true;
+        state->taken_cv.notify_all();
+    }
+
+    std::scoped_lock<std::mutex> lock{mutex};
+    if (--scheduled == 0) {
+        idle.notify_all();
+    }
+}
+
+void stream_engine::push(stream_id id, array_view<const telem_sample> samples) {
+    if (samples.size() == 0) {
+        return;
+    }
+
+    while (true) {
+        std::shared_ptr<stream_state> state = find_stream(id);
+        std::unique_lock<std::mutex> lock{state->mutex};
+        state->taken_cv.wait(lock, [&]() {
+            if (state->ended) {
+                return state->finished;
+            }
+            return state->queued.empty() || state->queued.size() + samples.size() <= MAX_QUEUED_SAMPLES;
+        });
+
+        // The stream was ended and has finished, so the
+        // samples start a new one
+        if (state->ended) {
+            continue;
+        }
+
+        state->queued.insert(state->queued.end(), samples.begin(), samples.end());
+        if (!state->scheduled) {
+            state->scheduled = true;
+            lock.unlock();
+            submit(std::move(state));
+        }
+        return;
+    }
+}
+
+void stream_engine::end(stream_id id) {
+    std::shared_ptr<stream_state> state;
+    {
+        std::scoped_lock<std::mutex> lock{mutex};
+        auto it = streams.find(id);
+        if (it == streams.end()) {
+            return;
+        }
+
+        state = it->second;
+    }
+
+    std::unique_lock<std::mutex> lock{state->mutex};
+    if (state->ended) {
+        return;
+    }
+    state->ended = true;
+    state->taken_cv.notify_all();
+    if (!state->scheduled) {
+        state->scheduled = true;
+        lock.unlock();
+        submit(std::move(state));
+    }
+}
+
+void stream_engine::wait() {
+    std::unique_lock<std::mutex> lock{mutex};
+    idle.wait(lock, [this]() {
+        return scheduled == 0;
+    });
+}
+
+size_t stream_engine::size() const {
+    std::scoped_lock<std::mutex> lock{mutex};
+    return streams.size();
+}
@@ -0,0 +1,255 @@
+/**
+ * @file
+ */
+
+#ifndef TELEM_FILTER_STREAM_ENGINE_H
+#define TELEM_FILTER_STREAM_ENGINE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "array_view.h"
+#include "stream_pipeline.h"
+#include "telem_data.h"
+#include "thread_pool.h"
+
+/**
+ * The most samples queued for a stream before push() waits
+ * for the stream to catch up, which bounds the memory of a
+ * stream that arrives faster than it is processed.
+ */
+static const size_t MAX_QUEUED_SAMPLES = 16384;
+
+/**
+ * @brief Runs the stages on many telemetry streams at once,
+ * each identified by a number and owning its own stage
+ * state.
+ *
+ * Every stream has a stream_pipeline, holding its filter
+ * histories, integrals and last sample, and a queue of the
+ * samples pushed to it. Streams with queued samples are run
+ * on a shared thread_pool, one task per stream at a time, so
+ * that the samples of a stream are processed in order while
+ * different streams are processed in parallel. Each task
+ * takes the samples queued so far, then submits the stream
+ * again if more have arrived, so that a busy stream does not
+ * keep a worker from the others.
+ *
+ * The memory of a stream is bounded by its plateau and
+ * filter delay, as for stream_pipeline, and by
+ * MAX_QUEUED_SAMPLES. A stream is created by the first
+ * sample pushed to it and destroyed once ended and its last
+ * task has finished.
+ */
+class stream_engine {
+public:
+    /**
+     * The identifier of a stream.
+     */
+    using stream_id = uint32_t;
+
+    /**
+     * Receives the velocities completed for a stream, which
+     * it may consume and clear.
+     *
+     * Called from the workers of the pool, never
+     * concurrently for the same stream but concurrently for
+     * different streams. Must not throw.
+     */
+    using output_handler = std::function<void(stream_id id, stream_outputs &outputs)>;
+
+private:
+    /**
+     * @brief The state of one stream.
+     */
+    struct stream_state {
+        /**
+         * The identifier of the stream.
+         */
+        stream_id id;
+        /**
+         * The stages run on the stream, used only by the task
+         * running the stream.
+         */
+        stream_pipeline pipeline;
+        /**
+         * The velocities completed by the task running the
+         * stream, passed to the handler.
+         */
+        stream_outputs outputs;
+        /**
+         * The samples taken by the task running the stream.
+         */
+        std::vector<telem_sample> taken;
+
+        /**
+         * The mutex used to protect access to the queue and
+         * flags.
+         */
+        std::mutex mutex;
+        /**
+         * The condition variable used to wake pushes waiting
+         * for the queue to be taken, or for the stream to
+         * finish.
+         */
+        std::condition_variable taken_cv;
+        /**
+         * The samples pushed but not yet taken.
+         */
+        std::vector<telem_sample> queued;
+        /**
+         * Whether a task is running the stream or is
+         * submitted to.
+         */
+        bool scheduled{false};
+        /**
+         * Whether the stream has been ended, after which no
+         * more samples are queued to it.
+         */
+        bool ended{false};
+        /**
+         * Whether the stream has been ended and its last task
+         * has finished, after which it is no longer found by
+         * its identifier.
+         */
+        bool finished{false};
+
+        /**
+         * Creates the state of a new stream.
+         *
+         * @param id the identifier of the stream
+         * @param lpf_type the low-pass filter design of stage
+         * 2
+         */
+        stream_state(stream_id id, stage_2_lpf lpf_type);
+    };
+
+    /**
+     * The pool on which the streams are run.
+     */
+    thread_pool &pool;
+    /**
+     * The low-pass filter design of stage 2.
+     */
+    stage_2_lpf lpf_type;
+    /**
+     * The handler receiving the velocities of every stream.
+     */
+    output_handler handler;
+
+    /**
+     * The mutex used to protect access to the streams and
+     * the number scheduled.
+     */
+    mutable std::mutex mutex;
+    /**
+     * The condition variable used to wake wait() once no
+     * stream is scheduled.
+     */
+    std::condition_variable idle;
+    /**
+     * The streams which have not finished, including ended
+     * streams whose last task is still running.
+     */
+    std::unordered_map<stream_id, std::shared_ptr<stream_state>> streams;
+    /**
+     * The number of streams scheduled on the pool, including
+     * ended streams still being run.
+     */
+    size_t scheduled{0};
+
+    /**
+     * Obtains the stream with the given identifier, creating
+     * it if it does not exist.
+     *
+     * @param id the identifier of the stream
+     * @return the stream
+     */
+    std::shared_ptr<stream_state> find_stream(stream_id id);
+
+    /**
+     * Submits a task running a stream to the pool.
+     *
+     * @param state the stream, which is scheduled
+     */
+    void submit(std::shared_ptr<stream_state> state);
+
+    /**
+     * Processes the samples queued for a stream, and then
+     * resubmits or unschedules it.
+     *
+     * @param state the stream
+     */
+    void run(const std::shared_ptr<stream_state> &state);
+
+public:
+    /**
+     * Creates a new engine with no streams.
+     *
+     * @param pool the pool on which to run the streams,
+     * which must outlive the engine
+     * @param handler the handler receiving the velocities of
+     * every stream
+     * @param lpf_type the low-pass filter design of stage 2
+     * @throws std::invalid_argument if the filter is
+     * zero-phase, which cannot be applied to a stream
+     */
+    stream_engine(thread_pool &pool, output_handler handler,
+                  stage_2_lpf lpf_type = stage_2_lpf::parks_mcclellan);
+
+    /**
+     * Waits for the samples already pushed to be processed.
+     * Streams which have not been ended are discarded with
+     * their held back samples.
+     */
+    ~stream_engine();
+
+    stream_engine(const stream_engine &) = delete;
+
+    stream_engine &operator=(const stream_engine &) = delete;
+
+    /**
+     * Queues samples to be processed by a stream, creating
+     * the stream if it does not exist. Waits while the queue
+     * of the stream is full, or while a stream of the same
+     * identifier which has been ended is still running, so
+     * must not be called from a task of the pool.
+     *
+     * @param id the identifier of the stream
+     * @param samples the next samples of the stream
+     */
+    void push(stream_id id, array_view<const telem_sample> samples);
+
+    /**
+     * Ends a stream, processing its held back samples as at
+     * the end of a flight and then destroying it. Samples
+     * pushed under the identifier afterwards start a new
+     * stream once the ended stream has finished, so that the
+     * handler is never called for both at once.
+     *
+     * @param id the identifier of the stream, which is
+     * ignored if it does not exist
+     */
+    void end(stream_id id);
+
+    /**
+     * Waits for every sample pushed so far to be processed
+     * and passed to the handler.
+     */
+    void wait();
+
+    /**
+     * Obtains the number of streams which have not finished,
+     * including ended streams which are still running.
+     *
+     * @return the number of streams
+     */
+    [[nodiscard]] size_t size() const;
+};
+
+#endif // TELEM_FILTER_STREAM_ENGINE_H
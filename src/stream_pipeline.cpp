@@ -0,0 +1,147 @@
+#include "stream_pipeline.h"
+
+stream_pipeline::stream_pipeline(stage_2_lpf lpf_type) :
+        x_lpf(make_stage_2_stream_lpf(lpf_type, filter_delay)),
+        y_lpf(make_stage_2_stream_lpf(lpf_type, filter_delay)) {
+}
+
+void stream_pipeline::process(double time, double velocity, double altitude, stream_outputs &outputs) {
+    if (finished) {
+        return;
+    }
+
+    // Stage 1, with the time step of telem_data::time_step()
+    // on the raw grid
+    double dt = processed == 0 ? time : time - processed_time;
+    processed_time = time;
+    ++processed;
+
+    vector2d v_extracted = extract_velocity(velocity, v_y_a_integral, altitude, dt);
+    v_y_a_integral += v_extracted.get_y() * dt / 1000;
+    outputs.stage_1.push_back({time, v_extracted, v_extracted.mag() - velocity, v_y_a_integral - altitude});
+
+    finished = time > STAGE_1_END_TIME;
+
+    // Stage 2, which pairs each filtered velocity with the
+    // sample the filter delay before it
+    history.push_back({time, velocity, altitude, dt});
+    vector2d v_filtered{x_lpf->process(v_extracted.get_x()), y_lpf->process(v_extracted.get_y())};
+    if (history.size() <= filter_delay) {
+        return;
+    }
+
+    const processed_sample &paired = history.front();
+    v_y_f_integral += v_filtered.get_y() * paired.dt / 1000;
+    double altitude_error = v_y_f_integral - paired.altitude;
+    outputs.stage_2.push_back({paired.time, v_filtered, v_filtered.mag() - paired.velocity, altitude_error});
+
+    // Stage 3, which keeps the filtered v_y, so shares the
+    // altitude error of stage 2
+    vector2d v_adjusted = adjust_velocity(paired.velocity, v_filtered.get_y());
+    outputs.stage_3.push_back({paired.time, v_adjusted, v_adjusted.mag() - paired.velocity, altitude_error});
+
+    history.pop_front();
+}
+
+void stream_pipeline::close_plateau(const telem_sample &end, stream_outputs &outputs) {
+    // The same line as plateau_lerp() draws between the
+    // samples at which the altitude changes
+    double t_left = plateau_start.time;
+    double v_left = plateau_start.altitude;
+    double slope = (end.altitude - v_left) / (end.time - t_left);
+    for (const telem_sample &sample : plateau) {
+        process(sample.time, sample.velocity, v_left + slope * (sample.time - t_left), outputs);
+    }
+    process(end.time, end.velocity, end.altitude, outputs);
+
+    plateau.clear();
+    plateau_start = end;
+}
+
+void stream_pipeline::push(const telem_sample &sample, stream_outputs &outputs) {
+    if (finished || (received != 0 && sample.time <= last.time)) {
+        return;
+    }
+
+    bool first = received == 0;
+    ++received;
+
+    if (first) {
+        process(sample.time, sample.velocity, sample.altitude, outputs);
+        plateau_start = sample;
+    } else if (sample.altitude != last.altitude) {
+        close_plateau(sample, outputs);
+    } else {
+        plateau.push_back(sample);
+        if (plateau.size() > MAX_PLATEAU_SAMPLES) {
+            finish(outputs);
+        }
+    }
+
+    last = sample;
+}
+
+void stream_pipeline::finish(stream_outputs &outputs) {
+    if (plateau.empty()) {
+        return;
+    }
+
+    // The last sample is kept, as at the end of a batch, so
+    // the rest of the plateau stays flat
+    telem_sample end = plateau.back();
+    plateau.pop_back();
+    close_plateau(end, outputs);
+}
+
+void stream_pipeline::reset() {
+    x_lpf->reset();
+    y_lpf->reset();
+
+    received = 0;
+    plateau.clear();
+    processed = 0;
+    processed_time = 0;
+    finished = false;
+    v_y_a_integral = 0;
+    history.clear();
+    v_y_f_integral = 0;
+}
+
+size_t stream_pipeline::size() const {
+    return received;
+}
+
+bool stream_pipeline::is_finished() const {
+    return finished;
+}
+
+/**
+ * Appends a row to the CSV text for each velocity of a
+ * stage.
+ *
+ * @param buffer the CSV text
+ * @param stage the label of the stage
+ * @param samples the velocities
+ */
+static void append_stage_rows(std::string &buffer, const char *stage, const std::vector<stage_sample> &samples) {
+    for (const stage_sample &sample : samples) {
+        buffer += stage;
+        buffer += ',';
+        append_csv_value(buffer, sample.time);
+        buffer += ',';
+        append_csv_value(buffer, sample.velocity.get_x());
+        buffer += ',';
+        append_csv_value(buffer, sample.velocity.get_y());
+        buffer += ',';
+        append_csv_value(buffer, sample.velocity_error);
+        buffer += ',';
+        append_csv_value(buffer, sample.altitude_error);
+        buffer += '\n';
+    }
+}
+
+void format_stream_csv(const stream_outputs &outputs, std::string &buffer) {
+    append_stage_rows(buffer, "1", outputs.stage_1);
+    append_stage_rows(buffer, "2", outputs.stage_2);
+    append_stage_rows(buffer, "3", outputs.stage_3);
+}
@@ -0,0 +1,254 @@
+/**
+ * @file
+ */
+
+#ifndef TELEM_FILTER_STREAM_PIPELINE_H
+#define TELEM_FILTER_STREAM_PIPELINE_H
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "signal_filter.h"
+#include "telem_data.h"
+#include "telem_pipeline.h"
+#include "vector2d.h"
+
+/**
+ * The longest altitude plateau held back waiting for the
+ * altitude to change, in samples. Longer plateaus are
+ * closed early as if the stream had ended, which bounds the
+ * memory of a stream.
+ */
+static const size_t MAX_PLATEAU_SAMPLES = 4096;
+
+/**
+ * @brief A velocity produced by a stage of a stream
+ * pipeline, with the errors against its telemetry sample.
+ */
+struct stage_sample {
+    /**
+     * The time of the telemetry sample paired with the
+     * velocity, s.
+     */
+    double time{0};
+    /**
+     * The velocity.
+     */
+    vector2d velocity{};
+    /**
+     * The difference between the magnitude of the velocity
+     * and the telemetry velocity, m/s.
+     */
+    double velocity_error{0};
+    /**
+     * The difference between the altitude from integrating
+     * the vertical velocities and the telemetry altitude,
+     * km.
+     */
+    double altitude_error{0};
+};
+
+/**
+ * @brief The velocities produced by each stage of a stream
+ * pipeline, which callers clear once consumed.
+ */
+struct stream_outputs {
+    /**
+     * The velocities of stage 1.
+     */
+    std::vector<stage_sample> stage_1;
+    /**
+     * The velocities of stage 2.
+     */
+    std::vector<stage_sample> stage_2;
+    /**
+     * The velocities of stage 3.
+     */
+    std::vector<stage_sample> stage_3;
+};
+
+/**
+ * @brief Runs stages 1 to 3 on telemetry one sample at a
+ * time, as it arrives, keeping only the state each stage
+ * carries between samples.
+ *
+ * The outputs are those of run_pipeline() on the raw grid
+ * without decimation, up to rounding error, but each is
+ * produced as soon as the samples it depends on have
+ * arrived. Stage 1 waits for the end of each altitude
+ * plateau, which the interpolation needs, and stages 2 and
+ * 3 lag it by the filter delay. Samples after stage 1 ends
+ * are ignored, as are samples not later than the one
+ * before, which the stages have already moved past.
+ */
+class stream_pipeline {
+private:
+    /**
+     * @brief A processed telemetry sample waiting for its
+     * filtered velocity.
+     */
+    struct processed_sample {
+        /**
+         * The time offset, s.
+         */
+        double time;
+        /**
+         * The velocity magnitude, m/s.
+         */
+        double velocity;
+        /**
+         * The interpolated altitude, km.
+         */
+        double altitude;
+        /**
+         * The time step to the sample, s.
+         */
+        double dt;
+    };
+
+    /**
+     * The number of samples by which the filters delay the
+     * velocities, which is set as the filters are created so
+     * must be declared before them.
+     */
+    unsigned int filter_delay{0};
+    /**
+     * The low-pass filter of the X velocities.
+     */
+    std::unique_ptr<signal_filter> x_lpf;
+    /**
+     * The low-pass filter of the Y velocities.
+     */
+    std::unique_ptr<signal_filter> y_lpf;
+
+    /**
+     * The number of samples accepted.
+     */
+    size_t received{0};
+    /**
+     * The last sample accepted.
+     */
+    telem_sample last{};
+    /**
+     * The sample starting the open altitude plateau.
+     */
+    telem_sample plateau_start{};
+    /**
+     * The samples of the open plateau after its start,
+     * whose altitudes are not yet known.
+     */
+    std::vector<telem_sample> plateau;
+
+    /**
+     * The number of samples processed by stage 1.
+     */
+    size_t processed{0};
+    /**
+     * The time offset of the last sample processed by stage
+     * 1, s.
+     */
+    double processed_time{0};
+    /**
+     * Whether stage 1 has passed its end time.
+     */
+    bool finished{false};
+    /**
+     * The altitude integrated from the stage 1 velocities,
+     * km.
+     */
+    double v_y_a_integral{0};
+
+    /**
+     * The processed samples whose filtered velocities are
+     * still delayed by the filters.
+     */
+    std::deque<processed_sample> history;
+    /**
+     * The altitude integrated from the filtered velocities,
+     * km.
+     */
+    double v_y_f_integral{0};
+
+    /**
+     * Runs a processed sample through every stage.
+     *
+     * @param time the time offset of the sample, s
+     * @param velocity the velocity magnitude, m/s
+     * @param altitude the interpolated altitude, km
+     * @param outputs the outputs to append to
+     */
+    void process(double time, double velocity, double altitude, stream_outputs &outputs);
+
+    /**
+     * Processes the samples of the open plateau at the
+     * altitudes of the line from its start to the given
+     * sample, which closes it.
+     *
+     * @param end the sample at which the plateau ends
+     * @param outputs the outputs to append to
+     */
+    void close_plateau(const telem_sample &end, stream_outputs &outputs);
+
+public:
+    /**
+     * Creates a new pipeline awaiting its first sample.
+     *
+     * @param lpf_type the low-pass filter design of stage 2
+     * @throws std::invalid_argument if the filter is
+     * zero-phase, which cannot be applied to a stream
+     */
+    explicit stream_pipeline(stage_2_lpf lpf_type = stage_2_lpf::parks_mcclellan);
+
+    /**
+     * Processes the next telemetry sample.
+     *
+     * @param sample the sample
+     * @param outputs the outputs to which the velocities
+     * completed by the sample are appended
+     */
+    void push(const telem_sample &sample, stream_outputs &outputs);
+
+    /**
+     * Processes the samples held back by the open plateau,
+     * as at the end of the stream. The pipeline may then be
+     * pushed further samples, which start a new plateau.
+     *
+     * @param outputs the outputs to append to
+     */
+    void finish(stream_outputs &outputs);
+
+    /**
+     * Discards every sample and the state of each stage, so
+     * that the pipeline can process a new stream.
+     */
+    void reset();
+
+    /**
+     * Obtains the number of samples accepted.
+     *
+     * @return the number of samples pushed, excluding those
+     * ignored
+     */
+    [[nodiscard]] size_t size() const;
+
+    /**
+     * Determines whether stage 1 has passed its end time,
+     * after which further samples are ignored.
+     *
+     * @return true if the stream has ended
+     */
+    [[nodiscard]] bool is_finished() const;
+};
+
+/**
+ * Appends the velocities of each stage to CSV text in the
+ * columns of write_pipeline_csv(), without the header.
+ *
+ * @param outputs the velocities
+ * @param buffer the CSV text
+ */
+void format_stream_csv(const stream_outputs &outputs, std::string &buffer);
+
+#endif // TELEM_FILTER_STREAM_PIPELINE_H
@@ -0,0 +1,263 @@
+#include "telem_cache.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "telem_data_json.h"
+
+/**
+ * The signature at the start of every cache file.
+ */
+static const char TELEM_CACHE_MAGIC[8] = {'T', 'E', 'L', 'E', 'M', 'C', 'O', 'L'};
+
+/**
+ * The current version of the cache file format.
+ */
+static const uint32_t TELEM_CACHE_VERSION = 1;
+
+/**
+ * The byte order marker written into the header.
+ */
+static const uint32_t TELEM_CACHE_BYTE_ORDER = 0x01020304;
+
+/**
+ * The alignment of each column, in bytes.
+ */
+static const uint64_t TELEM_CACHE_ALIGNMENT = 64;
+
+/**
+ * Rounds the offset up to the column alignment.
+ *
+ * @param offset the byte offset
+ * @return the aligned offset
+ */
+static uint64_t align_offset(uint64_t offset) {
+    return (offset + TELEM_CACHE_ALIGNMENT - 1) / TELEM_CACHE_ALIGNMENT * TELEM_CACHE_ALIGNMENT;
+}
+
+/**
+ * Computes the 64-bit FNV-1a checksum of the given bytes.
+ *
+ * @param data the pointer to the bytes
+ * @param size the number of bytes
+ * @return the checksum
+ */
+static uint64_t fnv1a(const char *data, size_t size) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+/**
+ * Obtains the size and modification time of a file.
+ *
+ * @param path the path to the file
+ * @param size the file size, in bytes
+ * @param mtime the modification time, in nanoseconds since
+ * the epoch
+ * @return true if the file could be queried
+ */
+static bool stat_file(const std::string &path, uint64_t &size, int64_t &mtime) {
+    struct stat st{};
+    if (stat(path.c_str(), &st) != 0) {
+        return false;
+    }
+
+    size = static_cast<uint64_t>(st.st_size);
+    mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    return true;
+}
+
+telem_cache::telem_cache(const std::string &cache_path) :
+        file(cache_path),
+        header(reinterpret_cast<const telem_cache_header *>(file.data())) {
+    if (file.size() < sizeof(telem_cache_header) ||
+        std::memcmp(header->magic, TELEM_CACHE_MAGIC, sizeof(TELEM_CACHE_MAGIC)) != 0) {
+        throw std::invalid_argument{"File is not a telemetry cache."};
+    }
+
+    if (header->version != TELEM_CACHE_VERSION ||
+        header->byte_order != TELEM_CACHE_BYTE_ORDER) {
+        throw std::invalid_argument{"Telemetry cache version is not supported."};
+    }
+
+    // Bound the count before sizing the columns with it, so
+    // that a corrupt count cannot overflow the column size
+    if (header->count > file.size() / sizeof(double)) {
+        throw std::invalid_argument{"Telemetry cache is truncated."};
+    }
+
+    uint64_t column_size = header->count * sizeof(double);
+    for (uint64_t offset : {header->time_offset, header->velocity_offset, header->altitude_offset}) {
+        if (offset % alignof(double) != 0 || offset > file.size() ||
+            file.size() - offset < column_size) {
+            throw std::invalid_argument{"Telemetry cache is truncated."};
+        }
+    }
+}
+
+size_t telem_cache::size() const {
+    return header->count;
+}
+
+const double *telem_cache::get_times() const {
+    return reinterpret_cast<const double *>(file.data() + header->time_offset);
+}
+
+const double *telem_cache::get_velocities() const {
+    return reinterpret_cast<const double *>(file.data() + header->velocity_offset);
+}
+
+const double *telem_cache::get_altitudes() const {
+    return reinterpret_cast<const double *>(file.data() + header->altitude_offset);
+}
+
+uint64_t telem_cache::get_source_checksum() const {
+    return header->source_checksum;
+}
+
+bool telem_cache::is_current(const std::string &json_path) const {
+    uint64_t size;
+    int64_t mtime;
+
+    // A cache without its source is still usable
+    if (!stat_file(json_path, size, mtime)) {
+        return true;
+    }
+
+    if (size != header->source_size) {
+        return false;
+    }
+    if (mtime == header->source_mtime) {
+        return true;
+    }
+
+    // The source was touched or replaced by a file of the
+    // same size, so only its contents tell whether it changed
+    try {
+        mapped_file source{json_path};
+        return fnv1a(source.data(), source.size()) == header->source_checksum;
+    } catch (const std::invalid_argument &) {
+        return false;
+    }
+}
+
+void telem_cache::convert(const std::string &json_path, const std::string &cache_path) {
+    telem_cache_header header{};
+    std::memcpy(header.magic, TELEM_CACHE_MAGIC, sizeof(TELEM_CACHE_MAGIC));
+    header.version = TELEM_CACHE_VERSION;
+    header.byte_order = TELEM_CACHE_BYTE_ORDER;
+
+    if (!stat_file(json_path, header.source_size, header.source_mtime)) {
+        throw std::invalid_argument{"File could not be opened."};
+    }
+
+    {
+        mapped_file source{json_path};
+        header.source_checksum = fnv1a(source.data(), source.size());
+    }
+
+    telem_data_json data{json_path, 0};
+
+    // Lay out the columns back to back after the header
+    header.count = data.size();
+    uint64_t column_size = header.count * sizeof(double);
+    header.time_offset = align_offset(sizeof(telem_cache_header));
+    header.velocity_offset = align_offset(header.time_offset + column_size);
+    header.altitude_offset = align_offset(header.velocity_offset + column_size);
+
+    // Each conversion writes a temporary file of its own next
+    // to the cache, so concurrent conversions of the same
+    // cache do not write over each other
+    std::string tmp_path = cache_path + ".XXXXXX";
+    int tmp_fd = mkstemp(tmp_path.data());
+    if (tmp_fd == -1) {
+        throw std::invalid_argument{"File could not be opened."};
+    }
+
+    // mkstemp() makes the file private to its owner, which
+    // the cache replacing the target should not be
+    fchmod(tmp_fd, 0644);
+    close(tmp_fd);
+
+    std::ofstream cache_file{tmp_path, std::ios::binary | std::ios::trunc};
+    if (!cache_file.good()) {
+        cache_file.close();
+        std::remove(tmp_path.c_str());
+        throw std::invalid_argument{"File could not be opened."};
+    }
+
+    const char padding[TELEM_CACHE_ALIGNMENT] = {};
+    uint64_t pos = 0;
+    auto write_at = [&](uint64_t offset, const void *src, uint64_t len) {
+        cache_file.write(padding, offset - pos);
+        cache_file.write(static_cast<const char *>(src), len);
+        pos = offset + len;
+    };
+
+    write_at(0, &header, sizeof(header));
+    write_at(header.time_offset, data.get_times().data(), column_size);
+    write_at(header.velocity_offset, data.get_velocities().data(), column_size);
+    write_at(header.altitude_offset, data.get_altitudes().data(), column_size);
+
+    cache_file.close();
+    if (!cache_file.good() || std::rename(tmp_path.c_str(), cache_path.c_str()) != 0) {
+        std::remove(tmp_path.c_str());
+        throw std::invalid_argument{"Telemetry cache could not be written."};
+    }
+}
+
+/**
+ * Maps the cache at the given path if it is valid and up to
+ * date with its source, converting the source otherwise.
+ *
+ * @param json_path the path to the JSON source
+ * @param cache_path the path to the cache file
+ * @return the up to date cache
+ */
+static telem_cache open_current(const std::string &json_path, const std::string &cache_path) {
+    try {
+        telem_cache cache{cache_path};
+        if (cache.is_current(json_path)) {
+            return cache;
+        }
+    } catch (const std::invalid_argument &) {
+        // Missing or invalid caches are rebuilt below
+    }
+
+    telem_cache::convert(json_path, cache_path);
+    return telem_cache{cache_path};
+}
+
+/**
+ * Creates telemetry data viewing the columns of the given
+ * cache in place.
+ *
+ * @param cache the cache whose mapping is shared with the
+ * data
+ * @return the telemetry data
+ */
+static telem_data view_cache(const std::shared_ptr<const telem_cache> &cache) {
+    return {cache,
+            {cache->get_times(), cache->size()},
+            {cache->get_velocities(), cache->size()},
+            {cache->get_altitudes(), cache->size()}};
+}
+
+telem_data_cache::telem_data_cache(const std::string &json_path, const std::string &cache_path) :
+        telem_data(view_cache(std::make_shared<const telem_cache>(open_current(json_path, cache_path)))) {
+}
+
+telem_data_cache::telem_data_cache(const std::string &cache_path) :
+        telem_data(view_cache(std::make_shared<const telem_cache>(cache_path))) {
+}
@@ -0,0 +1,196 @@
+/**
+ * @file
+ */
+
+#ifndef TELEM_FILTER_TELEM_CACHE_H
+#define TELEM_FILTER_TELEM_CACHE_H
+
+#include <cstdint>
+#include <string>
+
+#include "mapped_file.h"
+#include "telem_data.h"
+
+/**
+ * @brief The on-disk header of a columnar telemetry cache
+ * file.
+ *
+ * The header is followed by the time, velocity and altitude
+ * columns, each an array of count doubles starting at the
+ * recorded byte offset. Offsets are aligned to 64 bytes so
+ * the columns can be used in place from a mapping.
+ */
+struct telem_cache_header {
+    /**
+     * The file signature, equal to TELEM_CACHE_MAGIC.
+     */
+    char magic[8];
+    /**
+     * The format version, equal to TELEM_CACHE_VERSION.
+     */
+    uint32_t version;
+    /**
+     * The value 0x01020304 as written by the producing
+     * machine, used to detect a byte order mismatch.
+     */
+    uint32_t byte_order;
+    /**
+     * The number of samples in each column.
+     */
+    uint64_t count;
+    /**
+     * The size of the source JSON file, in bytes.
+     */
+    uint64_t source_size;
+    /**
+     * The modification time of the source JSON file, in
+     * nanoseconds since the epoch.
+     */
+    int64_t source_mtime;
+    /**
+     * The 64-bit FNV-1a checksum of the source JSON file.
+     */
+    uint64_t source_checksum;
+    /**
+     * The byte offset of the time column.
+     */
+    uint64_t time_offset;
+    /**
+     * The byte offset of the velocity column.
+     */
+    uint64_t velocity_offset;
+    /**
+     * The byte offset of the altitude column.
+     */
+    uint64_t altitude_offset;
+};
+
+/**
+ * @brief Represents a memory-mapped columnar telemetry
+ * cache file.
+ *
+ * Cache files are produced from the JSON telemetry data by
+ * convert() and allow the data to be loaded without parsing
+ * any text. The columns are read directly from the mapping.
+ */
+class telem_cache {
+private:
+    /**
+     * The mapping of the cache file.
+     */
+    mapped_file file;
+    /**
+     * The pointer to the header at the start of the
+     * mapping.
+     */
+    const telem_cache_header *header;
+
+public:
+    /**
+     * Maps and validates the cache file at the given path.
+     *
+     * @param cache_path the path to the cache file
+     * @throws std::invalid_argument if the file cannot be
+     * opened, or is not a cache file of the current version
+     * and byte order
+     */
+    explicit telem_cache(const std::string &cache_path);
+
+    /**
+     * Obtains the number of samples in the cache.
+     *
+     * @return the length of each column
+     */
+    [[nodiscard]] size_t size() const;
+
+    /**
+     * Obtains the time column.
+     *
+     * @return the pointer to size() time offsets, sorted in
+     * ascending order
+     */
+    [[nodiscard]] const double *get_times() const;
+
+    /**
+     * Obtains the velocity column.
+     *
+     * @return the pointer to size() velocity magnitudes
+     */
+    [[nodiscard]] const double *get_velocities() const;
+
+    /**
+     * Obtains the altitude column.
+     *
+     * @return the pointer to size() altitudes
+     */
+    [[nodiscard]] const double *get_altitudes() const;
+
+    /**
+     * Obtains the checksum of the JSON file this cache was
+     * converted from.
+     *
+     * @return the 64-bit FNV-1a checksum of the source
+     */
+    [[nodiscard]] uint64_t get_source_checksum() const;
+
+    /**
+     * Determines whether this cache was converted from the
+     * current contents of the given JSON file, judging by
+     * its size and modification time, or by its checksum if
+     * only the modification time differs.
+     *
+     * @param json_path the path to the JSON source
+     * @return true if the source has not changed since the
+     * conversion
+     */
+    [[nodiscard]] bool is_current(const std::string &json_path) const;
+
+    /**
+     * Parses the JSON telemetry file and writes its columns
+     * to a new cache file.
+     *
+     * The cache is written to a uniquely named temporary
+     * file in the same directory, which then replaces the
+     * target, so readers never observe a partially written
+     * cache and concurrent conversions do not collide.
+     *
+     * @param json_path the path to the JSON source
+     * @param cache_path the path of the cache to write
+     * @throws std::invalid_argument if the source cannot be
+     * read or the cache cannot be written
+     */
+    static void convert(const std::string &json_path, const std::string &cache_path);
+};
+
+/**
+ * @brief Telemetry data loaded from a columnar cache file,
+ * which is rebuilt from its JSON source whenever the source
+ * has changed, if the source is given.
+ */
+class telem_data_cache : public telem_data {
+public:
+    /**
+     * Loads the telemetry data from the cache file,
+     * converting the JSON source first if the cache is
+     * missing, invalid or older than the source.
+     *
+     * @param json_path the path to the JSON source
+     * @param cache_path the path to the cache file
+     * @throws std::invalid_argument if neither file can be
+     * read or the cache cannot be written
+     */
+    telem_data_cache(const std::string &json_path, const std::string &cache_path);
+
+    /**
+     * Loads the telemetry data from an existing cache file
+     * without checking it against its source.
+     *
+     * @param cache_path the path to the cache file
+     * @throws std::invalid_argument if the file cannot be
+     * opened, or is not a cache file of the current version
+     * and byte order
+     */
+    explicit telem_data_cache(const std::string &cache_path);
+};
+
+#endif // TELEM_FILTER_TELEM_CACHE_H
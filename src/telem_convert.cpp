@@ -0,0 +1,36 @@
+/**
+ * @file
+ */
+
+#include <iostream>
+
+#include "telem_cache.h"
+
+/**
+ * Converts a JSON telemetry file into a columnar cache
+ * file.
+ *
+ * @param argc the number of arguments
+ * @param argv the JSON source path followed by the cache
+ * path
+ * @return 0 on success
+ */
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <telemetry.json> <telemetry.telem>" << std::endl;
+        return 1;
+    }
+
+    try {
+        telem_cache::convert(argv[1], argv[2]);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    telem_cache cache{argv[2]};
+    std::cout << "Converted " << cache.size() << " samples (source checksum "
+              << std::hex << cache.get_source_checksum() << ")" << std::endl;
+
+    return 0;
+}
@@ -1,19 +1,217 @@
 #include "telem_data.h"
 
-telem_data::telem_data(std::map<double, double> velocities,
-                       std::map<double, double> altitudes) :
-        velocities(std::move(velocities)),
-        altitudes(std::move(altitudes)) {
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "prefix_sum.h"
+
+/**
+ * @brief The storage owned by telemetry data whose columns
+ * were created in memory.
+ */
+struct telem_columns {
+    /**
+     * The time column.
+     */
+    std::vector<double> times;
+    /**
+     * The velocity magnitude column.
+     */
+    std::vector<double> velocities;
+    /**
+     * The altitude column.
+     */
+    std::vector<double> altitudes;
+};
+
+/**
+ * Moves the given columns into shared storage.
+ *
+ * @param times the time column
+ * @param velocities the velocity magnitude column
+ * @param altitudes the altitude column
+ * @return the storage containing the columns
+ */
+static std::shared_ptr<const telem_columns> make_columns(std::vector<double> times,
+                                                         std::vector<double> velocities,
+                                                         std::vector<double> altitudes) {
+    return std::make_shared<const telem_columns>(
+            telem_columns{std::move(times), std::move(velocities), std::move(altitudes)});
+}
+
+/**
+ * Sorts the samples by time and splits them into columns,
+ * keeping only the last sample of those sharing a time.
+ *
+ * @param samples the samples to split
+ * @return the storage containing the columns
+ */
+static std::shared_ptr<const telem_columns> make_columns(std::vector<telem_sample> samples) {
+    auto time_less = [](const telem_sample &a, const telem_sample &b) {
+        return a.time < b.time;
+    };
+
+    // Recorded telemetry is almost always in order already
+    if (!std::is_sorted(samples.begin(), samples.end(), time_less)) {
+        std::stable_sort(samples.begin(), samples.end(), time_less);
+    }
+
+    std::vector<double> times;
+    std::vector<double> velocities;
+    std::vector<double> altitudes;
+    times.reserve(samples.size());
+    velocities.reserve(samples.size());
+    altitudes.reserve(samples.size());
+
+    for (const auto &sample : samples) {
+        if (!times.empty() && times.back() == sample.time) {
+            velocities.back() = sample.velocity;
+            altitudes.back() = sample.altitude;
+            continue;
+        }
+
+        times.push_back(sample.time);
+        velocities.push_back(sample.velocity);
+        altitudes.push_back(sample.altitude);
+    }
+
+    return make_columns(std::move(times), std::move(velocities), std::move(altitudes));
+}
+
+/**
+ * Creates telemetry data viewing the columns in the given
+ * storage.
+ *
+ * @param columns the column storage
+ * @return the telemetry data
+ */
+static telem_data view_columns(const std::shared_ptr<const telem_columns> &columns) {
+    return {columns, columns->times, columns->velocities, columns->altitudes};
+}
+
+telem_data::telem_data(std::vector<double> times,
+                       std::vector<double> velocities,
+                       std::vector<double> altitudes) :
+        telem_data(view_columns(make_columns(std::move(times),
+                                             std::move(velocities),
+                                             std::move(altitudes)))) {
+}
+
+/**
+ * Creates the time column of a uniform grid.
+ *
+ * @param start the time offset of the first sample
+ * @param period the time between consecutive samples
+ * @param len the number of samples
+ * @return the time column
+ * @throws std::invalid_argument if the period is not
+ * positive
+ */
+static std::vector<double> make_grid(double start, double period, size_t len) {
+    if (!(period > 0)) {
+        throw std::invalid_argument{"Sample period must be positive."};
+    }
+
+    // Multiply rather than accumulate so rounding errors do
+    // not build up along the grid
+    std::vector<double> times(len);
+    for (size_t i = 0; i < len; ++i) {
+        times[i] = start + static_cast<double>(i) * period;
+    }
+
+    return times;
+}
+
+telem_data::telem_data(double start,
+                       double period,
+                       std::vector<double> velocities,
+                       std::vector<double> altitudes) {
+    size_t len = velocities.size();
+    *this = {make_grid(start, period, len), std::move(velocities), std::move(altitudes)};
+    this->period = period;
 }
 
-telem_data::telem_data() :
-        telem_data({}, {}) {
+telem_data::telem_data(std::vector<telem_sample> samples) :
+        telem_data(view_columns(make_columns(std::move(samples)))) {
 }
 
-const std::map<double, double> &telem_data::get_velocities() const {
+telem_data::telem_data(std::shared_ptr<const void> storage,
+                       array_view<const double> times,
+                       array_view<const double> velocities,
+                       array_view<const double> altitudes) :
+        storage(std::move(storage)),
+        times(times),
+        velocities(velocities),
+        altitudes(altitudes) {
+    if (velocities.size() != times.size() || altitudes.size() != times.size()) {
+        throw std::invalid_argument{"Telemetry columns differ in length."};
+    }
+}
+
+telem_data::telem_data() = default;
+
+size_t telem_data::size() const {
+    return times.size();
+}
+
+array_view<const double> telem_data::get_times() const {
+    return times;
+}
+
+array_view<const double> telem_data::get_velocities() const {
     return velocities;
 }
 
-const std::map<double, double> &telem_data::get_altitudes() const {
+array_view<const double> telem_data::get_altitudes() const {
     return altitudes;
 }
+
+double telem_data::get_sample_period() const {
+    return period;
+}
+
+double telem_data::time_step(size_t i) const {
+    if (i == 0) {
+        return times[0];
+    }
+
+    return period != 0 ? period : times[i] - times[i - 1];
+}
+
+std::vector<double> telem_data::integrate(array_view<const double> values, unsigned int threads) const {
+    size_t len = values.size();
+    if (len > times.size()) {
+        throw std::invalid_argument{"Cannot integrate more values than samples."};
+    }
+
+    // The terms are independent, so only the running sum is
+    // carried between samples
+    std::vector<double> integral(len);
+    for (size_t i = 0; i < len; ++i) {
+        integral[i] = values[i] * time_step(i);
+    }
+    prefix_sum(integral, integral, summation::compensated, threads);
+
+    return integral;
+}
+
+size_t telem_data::index_of(double t) const {
+    size_t len = times.size();
+    if (period == 0 || len == 0) {
+        return std::lower_bound(times.begin(), times.end(), t) - times.begin();
+    }
+
+    // Estimate the index from the grid, then step past any
+    // rounding error in the grid times
+    double pos = std::ceil((t - times[0]) / period);
+    size_t i = !(pos > 0) ? 0 : static_cast<size_t>(std::min(pos, static_cast<double>(len)));
+    while (i > 0 && times[i - 1] >= t) {
+        --i;
+    }
+    while (i < len && times[i] < t) {
+        ++i;
+    }
+
+    return i;
+}
@@ -5,35 +5,132 @@
 #ifndef TELEM_FILTER_TELEM_DATA_H
 #define TELEM_FILTER_TELEM_DATA_H
 
-#include <map>
+#include <memory>
 #include <string>
+#include <vector>
+
+#include "array_view.h"
+
+/**
+ * @brief A single telemetry sample as recorded in the
+ * telemetry data file.
+ */
+struct telem_sample {
+    /**
+     * The time offset of the sample, s.
+     */
+    double time;
+    /**
+     * The velocity magnitude, m/s.
+     */
+    double velocity;
+    /**
+     * The altitude, km.
+     */
+    double altitude;
+};
 
 /**
  * @brief Represents telemetry data that consists of
  * velocity magnitude and altitude values.
+ *
+ * The data is stored as contiguous columns which share a
+ * single column of time offsets sorted in ascending order,
+ * such that the velocity and altitude at index i were
+ * sampled at the time at index i.
+ *
+ * The columns are immutable once created, so copies of an
+ * instance share the same underlying storage.
  */
 class telem_data {
+private:
+    /**
+     * The owner of the memory viewed by the columns, which
+     * is kept alive for as long as any copy of this data
+     * exists.
+     */
+    std::shared_ptr<const void> storage;
+
 protected:
     /**
-     * A mapping of time offsets to velocity magnitudes.
+     * The time offsets of each sample, in ascending order.
      */
-    std::map<double, double> velocities;
+    array_view<const double> times;
 
     /**
-     * A mapping of time offsets to altitudes.
+     * The velocity magnitudes of each sample.
      */
-    std::map<double, double> altitudes;
+    array_view<const double> velocities;
+
+    /**
+     * The altitudes of each sample.
+     */
+    array_view<const double> altitudes;
+
+    /**
+     * The time between consecutive samples if they lie on a
+     * uniform grid, or 0 otherwise.
+     */
+    double period{0};
 
 public:
     /**
      * Initializes the telemetry data with the given
-     * mappings of time to velocities and altitudes.
+     * columns.
+     *
+     * @param times the time offsets, in ascending order
+     * @param velocities the velocity magnitudes at each time
+     * @param altitudes the altitudes at each time
+     * @throws std::invalid_argument if the columns differ in
+     * length
+     */
+    telem_data(std::vector<double> times,
+               std::vector<double> velocities,
+               std::vector<double> altitudes);
+
+    /**
+     * Initializes the telemetry data with samples on a
+     * uniform time grid, the i-th of which has the time
+     * offset start + i * period.
+     *
+     * @param start the time offset of the first sample
+     * @param period the time between consecutive samples
+     * @param velocities the velocity magnitudes at each time
+     * @param altitudes the altitudes at each time
+     * @throws std::invalid_argument if the period is not
+     * positive or the columns differ in length
+     */
+    telem_data(double start,
+               double period,
+               std::vector<double> velocities,
+               std::vector<double> altitudes);
+
+    /**
+     * Initializes the telemetry data from samples in any
+     * order.
+     *
+     * The samples are sorted by time. Where several samples
+     * share the same time, the one appearing last is kept.
      *
-     * @param velocities the mapping of time to velocities
-     * @param altitudes the mapping of time to altitudes
+     * @param samples the telemetry samples
      */
-    telem_data(std::map<double, double> velocities,
-               std::map<double, double> altitudes);
+    explicit telem_data(std::vector<telem_sample> samples);
+
+    /**
+     * Initializes the telemetry data with columns residing
+     * in memory owned by another object, without copying.
+     *
+     * @param storage the owner of the column memory
+     * @param times the time offsets, in ascending order
+     * @param velocities the velocity magnitudes at each time
+     * @param altitudes the altitudes at each time
+     * @throws std::invalid_argument if the columns differ in
+     * length
+     */
+    telem_data(std::shared_ptr<const void> storage,
+               array_view<const double> times,
+               array_view<const double> velocities,
+               array_view<const double> altitudes);
 
     /**
      * Initializes the telemetry data with empty datasets.
@@ -41,19 +138,80 @@ public:
     telem_data();
 
     /**
-     * Obtains the mapping of time offsets to velocity
-     * magnitudes.
+     * Obtains the number of samples in the data.
+     *
+     * @return the length of each column
+     */
+    [[nodiscard]] size_t size() const;
+
+    /**
+     * Obtains the time offset of each sample.
+     *
+     * @return the time column, in ascending order
+     */
+    [[nodiscard]] array_view<const double> get_times() const;
+
+    /**
+     * Obtains the velocity magnitude of each sample.
+     *
+     * @return the velocity magnitude column
+     */
+    [[nodiscard]] array_view<const double> get_velocities() const;
+
+    /**
+     * Obtains the altitude of each sample.
+     *
+     * @return the altitude column
+     */
+    [[nodiscard]] array_view<const double> get_altitudes() const;
+
+    /**
+     * Obtains the time between consecutive samples if they
+     * lie on a uniform grid.
+     *
+     * @return the sample period, or 0 if the samples are not
+     * known to be uniformly spaced
+     */
+    [[nodiscard]] double get_sample_period() const;
+
+    /**
+     * Obtains the time elapsed before the given sample since
+     * the prior sample, or since time 0 for the first
+     * sample.
+     *
+     * @param i the index of the sample
+     * @return the time step, which is the sample period for
+     * every sample but the first on a uniform grid
+     */
+    [[nodiscard]] double time_step(size_t i) const;
+
+    /**
+     * Integrates a quantity sampled at the sample times,
+     * adding the product of each value and its time_step().
+     *
+     * The running sums are computed by a compensated
+     * parallel prefix sum, so long flights use every core.
      *
-     * @return the time to velocity magnitude map
+     * @param values the quantity at each of the first
+     * values.size() samples, which must not exceed size()
+     * @param threads the maximum number of threads to use,
+     * or 0 to use one thread per hardware core
+     * @return the integral up to and including each sample
+     * @throws std::invalid_argument if there are more values
+     * than samples
      */
-    [[nodiscard]] const std::map<double, double> &get_velocities() const;
+    [[nodiscard]] std::vector<double> integrate(array_view<const double> values, unsigned int threads = 0) const;
 
     /**
-     * Obtains the mapping of time offsets to altitude.
+     * Finds the first sample whose time offset is not less
+     * than the given time, directly from the sample period
+     * on a uniform grid and using a binary search otherwise.
      *
-     * @return the time to altitude map
+     * @param t the time offset to search for
+     * @return the index of the sample, or size() if every
+     * sample is earlier than t
      */
-    [[nodiscard]] const std::map<double, double> &get_altitudes() const;
+    [[nodiscard]] size_t index_of(double t) const;
 };
 
 #endif // TELEM_FILTER_TELEM_DATA_H
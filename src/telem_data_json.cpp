@@ -1,26 +1,119 @@
 #include "telem_data_json.h"
 
-#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <thread>
+#include <vector>
 
-#include <nlohmann/json.hpp>
+#include "mapped_file.h"
+#include "telem_json_parser.h"
 
-telem_data_json::telem_data_json(const std::string &file_path) {
-    std::ifstream telem_file{file_path};
-    if (!telem_file.good()) {
-        telem_file.close();
-        throw std::invalid_argument{"File could not be opened."};
+/**
+ * The smallest chunk worth handing to its own thread, in
+ * bytes. Smaller files are parsed with fewer threads.
+ */
+static const size_t MIN_CHUNK_SIZE = 256 * 1024;
+
+/**
+ * Splits the buffer into at most the given number of
+ * chunks, each of which ends just past a line terminator
+ * (or at the end of the buffer).
+ *
+ * @param begin the start of the buffer
+ * @param end the end of the buffer
+ * @param chunks the maximum number of chunks
+ * @return the chunk boundaries, starting with begin and
+ * ending with end
+ */
+static std::vector<const char *> split_lines(const char *begin, const char *end, size_t chunks) {
+    std::vector<const char *> bounds{begin};
+
+    size_t size = end - begin;
+    for (size_t i = 1; i < chunks; ++i) {
+        const char *split = begin + size * i / chunks;
+        if (split <= bounds.back()) {
+            continue;
+        }
+
+        const auto *nl = static_cast<const char *>(std::memchr(split, '\n', end - split));
+        if (nl == nullptr) {
+            break;
+        }
+
+        bounds.push_back(nl + 1);
     }
 
-    std::string line;
-    while (std::getline(telem_file, line)) {
-        const auto &json = nlohmann::json::parse(line);
-        double t = json["time"];
-        double velocity = json["velocity"];
-        double altitude = json["altitude"];
+    if (bounds.back() != end) {
+        bounds.push_back(end);
+    }
+
+    return bounds;
+}
+
+/**
+ * Maps the telemetry file at the given path and parses it
+ * in parallel.
+ *
+ * @param file_path the path to the telemetry file
+ * @param threads the number of threads to parse with, or 0
+ * to use one thread per hardware core
+ * @return the samples in file order
+ */
+static std::vector<telem_sample> parse_file(const std::string &file_path, unsigned int threads) {
+    mapped_file file{file_path};
+    const char *begin = file.data();
+    const char *end = begin + file.size();
+
+    if (threads == 0) {
+        threads = std::max(1U, std::thread::hardware_concurrency());
+    }
+
+    size_t chunks = std::min<size_t>(threads, file.size() / MIN_CHUNK_SIZE + 1);
+    std::vector<const char *> bounds = split_lines(begin, end, chunks);
+
+    // Parse each chunk on its own thread, keeping the first
+    // chunk for the calling thread
+    std::vector<std::vector<telem_sample>> samples(bounds.size() - 1);
+    std::vector<std::future<void>> tasks;
+    for (size_t i = 1; i + 1 < bounds.size(); ++i) {
+        tasks.push_back(std::async(std::launch::async, [&, i]() {
+            telem_json_parser::parse_lines(bounds[i], bounds[i + 1], samples[i]);
+        }));
+    }
 
-        velocities[t] = velocity;
-        altitudes[t] = altitude;
+    if (!samples.empty()) {
+        telem_json_parser::parse_lines(bounds[0], bounds[1], samples[0]);
     }
 
-    telem_file.close();
+    for (auto &task : tasks) {
+        task.get();
+    }
+
+    if (samples.size() == 1) {
+        return std::move(samples[0]);
+    }
+
+    // Concatenate in file order so that later duplicate
+    // times take precedence, as in a sequential read
+    size_t count = 0;
+    for (const auto &chunk : samples) {
+        count += chunk.size();
+    }
+
+    std::vector<telem_sample> merged;
+    merged.reserve(count);
+    for (const auto &chunk : samples) {
+        merged.insert(merged.end(), chunk.begin(), chunk.end());
+    }
+
+    return merged;
+}
+
+telem_data_json::telem_data_json(const std::string &file_path) :
+        telem_data_json(file_path, 1) {
+}
+
+telem_data_json::telem_data_json(const std::string &file_path, unsigned int threads) :
+        telem_data(parse_file(file_path, threads)) {
 }
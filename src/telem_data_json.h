@@ -23,6 +23,26 @@ public:
      * file is not valid
      */
     explicit telem_data_json(const std::string &file_path);
+
+    /**
+     * Initializes the telemetry data by mapping the data
+     * file at the given path into memory and parsing it in
+     * parallel.
+     *
+     * The file is split at line boundaries into one chunk
+     * per thread, each chunk is parsed independently and the
+     * results are merged in file order, so the resulting
+     * data is identical to that of the single-threaded
+     * constructor.
+     *
+     * @param file_path the path to the file containing
+     * telemetry data
+     * @param threads the number of threads to parse with, or
+     * 0 to use one thread per hardware core
+     * @throws std::invalid_argument if the path to the
+     * file is not valid
+     */
+    telem_data_json(const std::string &file_path, unsigned int threads);
 };
 
 #endif // TELEM_FILTER_TELEM_DATA_JSON_H
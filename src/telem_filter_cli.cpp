@@ -0,0 +1,397 @@
+/**
+ * @file
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "flight_batch.h"
+#include "stream_pipeline.h"
+#include "telem_pipeline.h"
+#include "telem_server.h"
+#include "telem_tail.h"
+
+/**
+ * The longest a followed file is waited on before checking
+ * whether to stop, ms.
+ */
+static const int FOLLOW_WAIT_TIMEOUT = 250;
+
+/**
+ * Whether an interrupt or termination signal has asked the
+ * program to stop following or serving.
+ */
+static volatile std::sig_atomic_t stop_requested = 0;
+
+/**
+ * Prints the usage of the program.
+ *
+ * @param program the name of the program
+ */
+static void print_usage(const char *program) {
+    std::cerr << "Usage: " << program
+              << " [--grid raw|linear|cubic] [--lpf pm|pm-zero-phase|butterworth] [--decimate N]"
+              << " <telemetry.json|telemetry.telem> <output.csv>" << std::endl
+              << "       " << program
+              << " [options] --batch [--threads N] <directory|manifest> <output directory>" << std::endl
+              << "       " << program
+              << " [--lpf pm|butterworth] --follow [--poll] <telemetry.json> <output.csv>" << std::endl
+              << "       " << program
+              << " [--lpf pm|butterworth] --serve [--threads N] <socket path|port>" << std::endl;
+}
+
+/**
+ * Signal handler asking the program to stop following or
+ * serving.
+ *
+ * @param signal the signal received
+ */
+static void request_stop(int signal) {
+    (void) signal;
+    stop_requested = 1;
+}
+
+/**
+ * Parses the name of a stage 1 time grid.
+ *
+ * @param name the name of the grid
+ * @return the grid
+ * @throws std::invalid_argument if the name is unknown
+ */
+static stage_1_grid parse_grid(const std::string &name) {
+    if (name == "raw") {
+        return stage_1_grid::raw;
+    }
+    if (name == "linear") {
+        return stage_1_grid::uniform_linear;
+    }
+    if (name == "cubic") {
+        return stage_1_grid::uniform_cubic;
+    }
+
+    throw std::invalid_argument{"Unknown time grid: " + name};
+}
+
+/**
+ * Parses the name of a stage 2 low-pass filter design.
+ *
+ * @param name the name of the filter design
+ * @return the filter design
+ * @throws std::invalid_argument if the name is unknown
+ */
+static stage_2_lpf parse_lpf(const std::string &name) {
+    if (name == "pm") {
+        return stage_2_lpf::parks_mcclellan;
+    }
+    if (name == "pm-zero-phase") {
+        return stage_2_lpf::parks_mcclellan_zero_phase;
+    }
+    if (name == "butterworth") {
+        return stage_2_lpf::butterworth;
+    }
+
+    throw std::invalid_argument{"Unknown low-pass filter: " + name};
+}
+
+/**
+ * Parses a count option, such as the decimation factor.
+ *
+ * @param value the count
+ * @return the count, which is nonzero
+ * @throws std::invalid_argument if the count is not a
+ * positive integer
+ */
+static unsigned int parse_count(const std::string &value) {
+    size_t end = 0;
+    unsigned long factor = 0;
+    try {
+        factor = std::stoul(value, &end);
+    } catch (const std::exception &) {
+        end = 0;
+    }
+
+    if (end == 0 || end != value.size() || factor == 0 || value[0] == '-') {
+        throw std::invalid_argument{"Expected a positive integer: " + value};
+    }
+
+    return factor;
+}
+
+/**
+ * Processes every flight of a batch and writes the outputs
+ * and a summary to the output directory.
+ *
+ * @param flights_path the path to the directory or
+ * manifest of flights
+ * @param output_dir the output directory
+ * @param options the options of each pipeline run
+ * @param threads the number of flights processed at once
+ * @return 0 if every flight succeeded
+ */
+static int run_batch(const std::string &flights_path,
+                     const std::string &output_dir,
+                     const pipeline_options &options,
+                     unsigned int threads) {
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<flight_summary> summaries;
+    try {
+        std::vector<std::string> flights = find_flights(flights_path);
+
+        thread_pool pool{threads};
+        summaries = process_flights(flights, output_dir, options, pool);
+        write_batch_summary(summaries, (std::filesystem::path{output_dir} / BATCH_SUMMARY_NAME).string());
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    size_t failed = 0;
+    for (const flight_summary &summary : summaries) {
+        if (!summary.error.empty()) {
+            std::cerr << summary.input_path << ": " << summary.error << std::endl;
+            ++failed;
+        }
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "Processed " << summaries.size() - failed << " of " << summaries.size() << " flights in "
+              << elapsed.count() << " s" << std::endl;
+
+    return failed == 0 ? 0 : 1;
+}
+
+/**
+ * Appends the velocities completed so far to the output and
+ * flushes it, so that readers of the output follow along.
+ *
+ * @param outputs the completed velocities, which are
+ * cleared
+ * @param buffer the buffer used to format the rows
+ * @param output the output file
+ * @throws std::invalid_argument if the output cannot be
+ * written
+ */
+static void write_stream_rows(stream_outputs &outputs, std::string &buffer, std::ofstream &output) {
+    buffer.clear();
+    format_stream_csv(outputs, buffer);
+    output.write(buffer.data(), buffer.size());
+    output.flush();
+    if (!output.good()) {
+        throw std::invalid_argument{"Output could not be written."};
+    }
+
+    outputs.stage_1.clear();
+    outputs.stage_2.clear();
+    outputs.stage_3.clear();
+}
+
+/**
+ * Follows a telemetry file as it is appended to, processing
+ * each new sample as it arrives and appending the resulting
+ * velocities to the output, until interrupted or stage 1
+ * ends.
+ *
+ * @param input_path the path to the followed file
+ * @param output_path the path to the CSV file to write
+ * @param options the options of the pipeline
+ * @param watch whether to watch the file with inotify,
+ * rather than polling it
+ * @return 0 on success
+ */
+static int run_follow(const std::string &input_path,
+                      const std::string &output_path,
+                      const pipeline_options &options,
+                      bool watch) {
+    if (options.grid != stage_1_grid::raw || options.decimation_factor != 0) {
+        std::cerr << "Follow mode only supports the raw grid without decimation." << std::endl;
+        return 1;
+    }
+
+    std::signal(SIGINT, request_stop);
+    std::signal(SIGTERM, request_stop);
+
+    size_t received = 0;
+    size_t filtered = 0;
+    try {
+        telem_tail tail{input_path, watch};
+        stream_pipeline pipeline{options.lpf_type};
+
+        std::ofstream output{output_path, std::ios::binary | std::ios::trunc};
+        if (!output.good()) {
+            throw std::invalid_argument{"File could not be opened."};
+        }
+        output << PIPELINE_CSV_HEADER;
+
+        std::vector<telem_sample> samples;
+        stream_outputs outputs;
+        std::string buffer;
+        while (!stop_requested && !pipeline.is_finished()) {
+            samples.clear();
+            if (tail.read(samples) == 0) {
+                tail.wait(FOLLOW_WAIT_TIMEOUT);
+                continue;
+            }
+
+            for (const telem_sample &sample : samples) {
+                pipeline.push(sample, outputs);
+            }
+            filtered += outputs.stage_3.size();
+            write_stream_rows(outputs, buffer, output);
+        }
+
+        // The writer may have finished without terminating
+        // its last line, and the open plateau is held back
+        if (!pipeline.is_finished()) {
+            samples.clear();
+            tail.read(samples);
+            try {
+                tail.flush(samples);
+            } catch (const std::exception &e) {
+                // A line cut off mid-write cannot be recovered
+                std::cerr << "Ignoring incomplete last line: " << e.what() << std::endl;
+            }
+            for (const telem_sample &sample : samples) {
+                pipeline.push(sample, outputs);
+            }
+            pipeline.finish(outputs);
+        }
+        filtered += outputs.stage_3.size();
+        write_stream_rows(outputs, buffer, output);
+
+        received = pipeline.size();
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << "Followed " << received << " samples: " << filtered << " stage 3 velocities" << std::endl;
+
+    return 0;
+}
+
+/**
+ * Serves the processing stages to local clients until
+ * interrupted.
+ *
+ * @param listen_address the path of the Unix domain socket,
+ * or a port number on the loopback interface
+ * @param options the options of the pipeline
+ * @param threads the number of workers running the streams
+ * @return 0 on success
+ */
+static int run_server(const std::string &listen_address, const pipeline_options &options, unsigned int threads) {
+    if (options.grid != stage_1_grid::raw || options.decimation_factor != 0) {
+        std::cerr << "Server mode only supports the raw grid without decimation." << std::endl;
+        return 1;
+    }
+
+    std::signal(SIGINT, request_stop);
+    std::signal(SIGTERM, request_stop);
+
+    try {
+        thread_pool pool{threads};
+        telem_server server{listen_address, pool, options.lpf_type};
+        std::cout << "Serving on " << server.get_address() << std::endl;
+        server.run(stop_requested);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * Runs the processing stages on a telemetry file, or on a
+ * batch of them, without plotting and writes the velocities
+ * of every stage to CSV files.
+ *
+ * @param argc the number of arguments
+ * @param argv the options, followed by the input path and
+ * the output path
+ * @return 0 on success
+ */
+int main(int argc, char **argv) {
+    pipeline_options options;
+    bool batch = false;
+    bool follow = false;
+    bool watch = true;
+    bool serve = false;
+    unsigned int threads = std::max(std::thread::hardware_concurrency(), 1U);
+    std::string paths[2];
+    int path_count = 0;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const char *arg = argv[i];
+            bool has_value = i + 1 < argc;
+            if (std::strcmp(arg, "--grid") == 0 && has_value) {
+                options.grid = parse_grid(argv[++i]);
+            } else if (std::strcmp(arg, "--lpf") == 0 && has_value) {
+                options.lpf_type = parse_lpf(argv[++i]);
+            } else if (std::strcmp(arg, "--decimate") == 0 && has_value) {
+                options.decimation_factor = parse_count(argv[++i]);
+            } else if (std::strcmp(arg, "--batch") == 0) {
+                batch = true;
+            } else if (std::strcmp(arg, "--follow") == 0) {
+                follow = true;
+            } else if (std::strcmp(arg, "--poll") == 0) {
+                watch = false;
+            } else if (std::strcmp(arg, "--serve") == 0) {
+                serve = true;
+            } else if (std::strcmp(arg, "--threads") == 0 && has_value) {
+                threads = parse_count(argv[++i]);
+            } else if (arg[0] != '-' && path_count < 2) {
+                paths[path_count++] = arg;
+            } else {
+                path_count = -1;
+                break;
+            }
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    if (path_count != (serve ? 1 : 2) || batch + follow + serve > 1) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    if (batch) {
+        return run_batch(paths[0], paths[1], options, threads);
+    }
+    if (follow) {
+        return run_follow(paths[0], paths[1], options, watch);
+    }
+    if (serve) {
+        return run_server(paths[0], options, threads);
+    }
+
+    pipeline_result result;
+    try {
+        telem_data raw_data = load_telemetry(paths[0]);
+        result = run_pipeline(raw_data, options);
+        write_pipeline_csv(result, paths[1]);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << "Processed " << result.processed_data.size() << " samples: "
+              << result.stage_1.velocities.size() << " stage 1, "
+              << result.stage_2.velocities.size() << " stage 2, "
+              << result.stage_3.velocities.size() << " stage 3 velocities" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,208 @@
+#include "telem_json_parser.h"
+
+#include <charconv>
+#include <cstring>
+
+#include <nlohmann/json.hpp>
+
+/**
+ * Advances the cursor past any JSON whitespace.
+ *
+ * @param it the cursor
+ * @param end the end of the line
+ * @return the first non-whitespace position
+ */
+static const char *skip_ws(const char *it, const char *end) {
+    while (it != end && (*it == ' ' || *it == '\t' || *it == '\r' || *it == '\n')) {
+        ++it;
+    }
+
+    return it;
+}
+
+/**
+ * Determines whether the quoted key starting at the cursor
+ * is equal to the given key.
+ *
+ * @param it the cursor, positioned after the opening quote
+ * @param end the end of the line
+ * @param key the expected key
+ * @param key_len the length of the expected key
+ * @return true if the key and its closing quote match
+ */
+static bool match_key(const char *it, const char *end, const char *key, size_t key_len) {
+    return static_cast<size_t>(end - it) > key_len &&
+           std::memcmp(it, key, key_len) == 0 &&
+           it[key_len] == '"';
+}
+
+/**
+ * Advances the cursor past any decimal digits.
+ *
+ * @param it the cursor
+ * @param end the end of the line
+ * @return the first position which is not a digit
+ */
+static const char *skip_digits(const char *it, const char *end) {
+    while (it != end && *it >= '0' && *it <= '9') {
+        ++it;
+    }
+
+    return it;
+}
+
+/**
+ * Finds the end of the JSON number starting at the cursor,
+ * following the JSON grammar, which is stricter than that
+ * of from_chars(): no leading zeros, no inf/nan spellings
+ * and at least one digit after a decimal point or exponent.
+ *
+ * @param it the cursor
+ * @param end the end of the line
+ * @return the end of the number, or nullptr if the cursor
+ * is not at a JSON number
+ */
+static const char *scan_number(const char *it, const char *end) {
+    if (it != end && *it == '-') {
+        ++it;
+    }
+
+    // The integer part is a single zero or starts with a
+    // non-zero digit
+    if (it == end || *it < '0' || *it > '9') {
+        return nullptr;
+    }
+    it = *it == '0' ? it + 1 : skip_digits(it, end);
+
+    if (it != end && *it == '.') {
+        const char *digits = it + 1;
+        it = skip_digits(digits, end);
+        if (it == digits) {
+            return nullptr;
+        }
+    }
+
+    if (it != end && (*it == 'e' || *it == 'E')) {
+        ++it;
+        if (it != end && (*it == '+' || *it == '-')) {
+            ++it;
+        }
+
+        const char *digits = it;
+        it = skip_digits(digits, end);
+        if (it == digits) {
+            return nullptr;
+        }
+    }
+
+    return it;
+}
+
+bool telem_json_parser::parse_fast(const char *begin, const char *end, telem_sample &sample) {
+    // Bit flags for each of the keys that have been seen
+    constexpr int TIME_BIT = 1;
+    constexpr int VELOCITY_BIT = 2;
+    constexpr int ALTITUDE_BIT = 4;
+
+    const char *it = skip_ws(begin, end);
+    if (it == end || *it != '{') {
+        return false;
+    }
+
+    int seen = 0;
+    while (true) {
+        it = skip_ws(it + 1, end);
+        if (it == end || *it != '"') {
+            return false;
+        }
+        ++it;
+
+        // Identify the key
+        double *target;
+        int bit;
+        size_t key_len;
+        if (match_key(it, end, "time", 4)) {
+            target = &sample.time;
+            bit = TIME_BIT;
+            key_len = 4;
+        } else if (match_key(it, end, "velocity", 8)) {
+            target = &sample.velocity;
+            bit = VELOCITY_BIT;
+            key_len = 8;
+        } else if (match_key(it, end, "altitude", 8)) {
+            target = &sample.altitude;
+            bit = ALTITUDE_BIT;
+            key_len = 8;
+        } else {
+            return false;
+        }
+
+        // Duplicate keys are left to the general parser
+        if ((seen & bit) != 0) {
+            return false;
+        }
+        seen |= bit;
+
+        it = skip_ws(it + key_len + 1, end);
+        if (it == end || *it != ':') {
+            return false;
+        }
+
+        // Only plain JSON numbers are accepted, leaving any
+        // spelling from_chars() permits beyond them, such as
+        // 01 or 1., to the general parser to reject
+        it = skip_ws(it + 1, end);
+        const char *number_end = scan_number(it, end);
+        if (number_end == nullptr) {
+            return false;
+        }
+
+        auto res = std::from_chars(it, number_end, *target);
+        if (res.ec != std::errc{} || res.ptr != number_end) {
+            return false;
+        }
+
+        it = skip_ws(number_end, end);
+        if (it == end) {
+            return false;
+        }
+
+        if (*it == '}') {
+            break;
+        }
+
+        if (*it != ',') {
+            return false;
+        }
+    }
+
+    return seen == (TIME_BIT | VELOCITY_BIT | ALTITUDE_BIT) &&
+           skip_ws(it + 1, end) == end;
+}
+
+telem_sample telem_json_parser::parse_line(const char *begin, const char *end) {
+    telem_sample sample{};
+    if (parse_fast(begin, end, sample)) {
+        return sample;
+    }
+
+    const auto &json = nlohmann::json::parse(begin, end);
+    sample.time = json.at("time");
+    sample.velocity = json.at("velocity");
+    sample.altitude = json.at("altitude");
+
+    return sample;
+}
+
+void telem_json_parser::parse_lines(const char *begin, const char *end,
+                                    std::vector<telem_sample> &samples) {
+    const char *line = begin;
+    while (line != end) {
+        const auto *nl = static_cast<const char *>(std::memchr(line, '\n', end - line));
+        const char *line_end = nl == nullptr ? end : nl;
+
+        samples.push_back(parse_line(line, line_end));
+
+        line = nl == nullptr ? end : nl + 1;
+    }
+}
@@ -0,0 +1,74 @@
+/**
+ * @file
+ */
+
+#ifndef TELEM_FILTER_TELEM_JSON_PARSER_H
+#define TELEM_FILTER_TELEM_JSON_PARSER_H
+
+#include <vector>
+
+#include "telem_data.h"
+
+/**
+ * @brief Parser for the newline-delimited JSON telemetry
+ * format produced by SpaceXtract.
+ *
+ * Every line of the data file is an object with exactly the
+ * "time", "velocity" and "altitude" number keys. Lines that
+ * follow this schema are scanned in place without building
+ * a JSON document; any other line falls back to the
+ * general-purpose nlohmann::json parser.
+ */
+class telem_json_parser {
+public:
+    /**
+     * Attempts to parse a single telemetry line using the
+     * schema-specialized scanner.
+     *
+     * The line must be a single object containing each of
+     * the three telemetry keys exactly once with plain
+     * number values, in any order and with any amount of
+     * JSON whitespace.
+     *
+     * @param begin the pointer to the first character of
+     * the line
+     * @param end the pointer past the last character of the
+     * line, excluding the line terminator
+     * @param sample the sample to write the parsed values
+     * into
+     * @return true if the line matched the schema, false if
+     * it must be parsed by the general parser instead
+     */
+    static bool parse_fast(const char *begin, const char *end, telem_sample &sample);
+
+    /**
+     * Parses a single telemetry line, falling back to the
+     * general JSON parser if the line does not match the
+     * schema exactly.
+     *
+     * @param begin the pointer to the first character of
+     * the line
+     * @param end the pointer past the last character of the
+     * line, excluding the line terminator
+     * @return the parsed sample
+     * @throws nlohmann::json::exception if the line is not
+     * valid JSON or is missing a telemetry key
+     */
+    static telem_sample parse_line(const char *begin, const char *end);
+
+    /**
+     * Parses every line in the given buffer and appends the
+     * resulting samples to the output vector.
+     *
+     * @param begin the pointer to the start of the buffer
+     * @param end the pointer past the end of the buffer
+     * @param samples the vector to which parsed samples are
+     * appended in file order
+     * @throws nlohmann::json::exception if any line cannot
+     * be parsed
+     */
+    static void parse_lines(const char *begin, const char *end,
+                            std::vector<telem_sample> &samples);
+};
+
+#endif // TELEM_FILTER_TELEM_JSON_PARSER_H
@@ -0,0 +1,407 @@
+#include "telem_pipeline.h"
+
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <future>
+#include <stdexcept>
+
+#include "csv_writer.h"
+#include "digital_filter.h"
+#include "fixed_fir.h"
+#include "fused_stages.h"
+#include "plateau_lerp.h"
+#include "pm_lpf_coeffs.h"
+#include "polyphase_filter.h"
+#include "resampler.h"
+#include "sos_filter.h"
+#include "telem_cache.h"
+#include "telem_data_json.h"
+
+/**
+ * The nominal telemetry sample rate, Hz, which is the rate
+ * of the uniform time grids.
+ */
+static const double SAMPLE_RATE = 30;
+
+/**
+ * The order of the Butterworth low-pass filter.
+ */
+static const unsigned int BUTTERWORTH_ORDER = 4;
+
+/**
+ * The cutoff frequency of the low-pass filters, Hz.
+ */
+static const double LPF_CUTOFF = 1;
+
+/**
+ * The delay of the anti-aliasing filter, in decimated
+ * samples. Longer filters have a sharper cutoff.
+ */
+static const unsigned int DECIMATION_DELAY = 4;
+
+/**
+ * Preallocates the columns of a stage result so that
+ * appending to them does not reallocate.
+ *
+ * @param result the stage result
+ * @param capacity the expected number of velocities
+ */
+static void reserve_result(stage_result &result, size_t capacity) {
+    result.velocities.reserve(capacity);
+    result.velocity_errors.reserve(capacity);
+    result.altitude_errors.reserve(capacity);
+}
+
+telem_data load_telemetry(const std::string &file_path, unsigned int threads) {
+    static const std::string CACHE_EXTENSION = ".telem";
+    if (file_path.size() >= CACHE_EXTENSION.size() &&
+        file_path.compare(file_path.size() - CACHE_EXTENSION.size(), CACHE_EXTENSION.size(), CACHE_EXTENSION) == 0) {
+        return telem_data_cache{file_path};
+    }
+
+    return telem_data_json{file_path, threads};
+}
+
+telem_data prepare_stage_1_data(const telem_data &raw_data, stage_1_grid grid, unsigned int threads) {
+    array_view<const double> raw_times = raw_data.get_times();
+    array_view<const double> raw_velocities = raw_data.get_velocities();
+
+    // Interpolate altitudes
+    std::vector<double> interp_altitudes(raw_data.size());
+    plateau_lerp(raw_times, raw_data.get_altitudes(), interp_altitudes, threads);
+
+    // Resample the interpolated plateaus rather than the raw
+    // steps
+    telem_data processed_data{{raw_times.begin(), raw_times.end()},
+                              {raw_velocities.begin(), raw_velocities.end()},
+                              std::move(interp_altitudes)};
+    if (grid == stage_1_grid::raw) {
+        return processed_data;
+    }
+
+    interpolation method = grid == stage_1_grid::uniform_cubic ? interpolation::cubic : interpolation::linear;
+    return uniform_resampler::resample(processed_data, SAMPLE_RATE, method);
+}
+
+vector2d extract_velocity(double v_mag, double alt_prev, double alt_next, double dt) {
+    double dy = (alt_next - alt_prev) * 1000;
+    double v_y = std::copysign(std::min(dy / dt, v_mag), dy);
+    double v_x = std::sqrt(v_mag * v_mag - v_y * v_y);
+
+    return {v_x, v_y};
+}
+
+stage_result process_stage_1(const telem_data &processed_data) {
+    array_view<const double> times = processed_data.get_times();
+    array_view<const double> velocities = processed_data.get_velocities();
+    array_view<const double> altitudes = processed_data.get_altitudes();
+
+    stage_result stage;
+    reserve_result(stage, times.size());
+
+    double v_y_a_integral = 0;
+
+    size_t len = times.size();
+    for (size_t i = 0; i < len; ++i) {
+        double t = times[i];
+        double v = velocities[i];
+        double alt = altitudes[i];
+
+        double dt = processed_data.time_step(i);
+
+        // Extract velocity
+        vector2d v_adjusted = extract_velocity(v, v_y_a_integral, alt, dt);
+        stage.velocities.push_back(t, v_adjusted);
+
+        v_y_a_integral += v_adjusted.get_y() * dt / 1000;
+
+        stage.velocity_errors.push_back(v_adjusted.mag() - v);
+        stage.altitude_errors.push_back(v_y_a_integral - alt);
+
+        if (t > STAGE_1_END_TIME) {
+            break;
+        }
+    }
+
+    return stage;
+}
+
+/**
+ * Determines whether the Parks-McClellan filter is
+ * specialized for its coefficients. fixed_fir only gains on
+ * the AVX-512 kernels; with narrower ones digital_filter is
+ * as fast or faster.
+ *
+ * @return true to filter with fixed_fir, false to filter
+ * with digital_filter
+ */
+static bool use_fixed_pm_lpf() {
+    return fir_kernels::detect() == simd_isa::avx512;
+}
+
+std::unique_ptr<signal_filter> make_stage_2_stream_lpf(stage_2_lpf lpf_type, unsigned int &filter_delay) {
+    if (lpf_type == stage_2_lpf::butterworth) {
+        sos_filter lpf = sos_filter::butterworth_lowpass(BUTTERWORTH_ORDER, LPF_CUTOFF, SAMPLE_RATE);
+        filter_delay = std::lround(lpf.dc_group_delay());
+
+        return std::make_unique<sos_filter>(std::move(lpf));
+    }
+    if (lpf_type == stage_2_lpf::parks_mcclellan_zero_phase) {
+        throw std::invalid_argument{"Zero-phase filtering cannot be streamed."};
+    }
+
+    filter_delay = PM_LPF_COEFFS.size() / 2;
+
+    if (use_fixed_pm_lpf()) {
+        return std::make_unique<fixed_fir<PM_LPF_COEFFS>>();
+    }
+    return std::make_unique<digital_filter>(std::vector<double>{PM_LPF_COEFFS.begin(), PM_LPF_COEFFS.end()});
+}
+
+stage_result process_stage_2(velocity_series_view v_stage_1,
+                             const telem_data &processed_data,
+                             stage_2_lpf lpf_type,
+                             unsigned int threads) {
+    // Process with LPF
+    std::vector<double> x_velocities_filtered;
+    std::vector<double> y_velocities_filtered;
+    unsigned int filter_delay;
+    if (lpf_type == stage_2_lpf::butterworth) {
+        sos_filter lpf = sos_filter::butterworth_lowpass(BUTTERWORTH_ORDER, LPF_CUTOFF, SAMPLE_RATE);
+        x_velocities_filtered = lpf.transform(v_stage_1.get_x());
+        y_velocities_filtered = lpf.transform(v_stage_1.get_y());
+
+        // Compensate for the delay of the slowly varying
+        // velocities, which dominate the signal
+        filter_delay = std::lround(lpf.dc_group_delay());
+    } else if (lpf_type == stage_2_lpf::parks_mcclellan_zero_phase) {
+        // The channels are independent, so filter X in the
+        // background while Y is filtered here
+        digital_filter lpf{{PM_LPF_COEFFS.begin(), PM_LPF_COEFFS.end()}};
+        std::launch policy = threads == 1 ? std::launch::deferred : std::launch::async;
+        std::future<std::vector<double>> x_task = std::async(policy, [&]() {
+            return lpf.filtfilt(v_stage_1.get_x());
+        });
+        y_velocities_filtered = lpf.filtfilt(v_stage_1.get_y());
+        x_velocities_filtered = x_task.get();
+
+        // Zero-phase filtering has no delay
+        filter_delay = 0;
+    } else {
+        // The coefficients are known at compile time, so the
+        // filter is specialized for them where that is faster
+        std::unique_ptr<signal_filter> lpf = make_stage_2_stream_lpf(lpf_type, filter_delay);
+        std::vector<std::vector<double>> filtered = lpf->transform_channels({v_stage_1.get_x(), v_stage_1.get_y()});
+        x_velocities_filtered = std::move(filtered[0]);
+        y_velocities_filtered = std::move(filtered[1]);
+    }
+
+    // Pair the velocities after the filter delay with the
+    // telemetry
+    stage_result stage;
+    size_t len = x_velocities_filtered.size();
+    reserve_result(stage, len);
+
+    array_view<const double> result_times = v_stage_1.get_times();
+    for (size_t i = filter_delay; i < len; ++i) {
+        stage.velocities.push_back(result_times[i], {x_velocities_filtered[i], y_velocities_filtered[i]});
+    }
+
+    // The whole result is known, so integrate it up front
+    // rather than carrying the sum through the error loop
+    std::vector<double> v_y_f_integral = processed_data.integrate(stage.velocities.view().get_y(), threads);
+
+    array_view<const double> velocities = processed_data.get_velocities();
+    array_view<const double> altitudes = processed_data.get_altitudes();
+    for (size_t i = 0; i < stage.velocities.size(); ++i) {
+        stage.velocity_errors.push_back(stage.velocities.get(i).mag() - velocities[i]);
+        stage.altitude_errors.push_back(v_y_f_integral[i] / 1000 - altitudes[i]);
+    }
+
+    return stage;
+}
+
+vector2d adjust_velocity(double v, double v_y_f) {
+    double v_sq = v * v;
+    double v_x_adjusted = std::sqrt(v_sq - std::min(v_y_f * v_y_f, v_sq));
+
+    return {v_x_adjusted, v_y_f};
+}
+
+stage_result process_stage_3(velocity_series_view v_stage_2,
+                             const telem_data &processed_data,
+                             unsigned int threads) {
+    array_view<const double> times = processed_data.get_times();
+    array_view<const double> velocities = processed_data.get_velocities();
+    array_view<const double> altitudes = processed_data.get_altitudes();
+
+    // The adjustment keeps v_y, so its integral is known up
+    // front
+    array_view<const double> v_y_filtered = v_stage_2.get_y();
+    std::vector<double> v_y_a_integral = processed_data.integrate(v_y_filtered, threads);
+
+    stage_result stage;
+    size_t len = v_stage_2.size();
+    reserve_result(stage, len);
+
+    for (size_t i = 0; i < len; ++i) {
+        double v = velocities[i];
+
+        vector2d v_adjusted = adjust_velocity(v, v_y_filtered[i]);
+        stage.velocities.push_back(times[i], v_adjusted);
+
+        stage.velocity_errors.push_back(v_adjusted.mag() - v);
+        stage.altitude_errors.push_back(v_y_a_integral[i] / 1000 - altitudes[i]);
+    }
+
+    return stage;
+}
+
+decimation_result process_decimation(velocity_series_view v_stage_2,
+                                      const telem_data &stage_2_data,
+                                      unsigned int factor) {
+    if (factor == 0) {
+        throw std::invalid_argument{"Decimation factor must be nonzero."};
+    }
+
+    // Decimate the processed data by picking every
+    // factor-th sample, as the decimator does
+    std::vector<double> times;
+    std::vector<double> velocities;
+    std::vector<double> altitudes;
+    size_t decimated_len = (stage_2_data.size() + factor - 1) / factor;
+    times.reserve(decimated_len);
+    velocities.reserve(decimated_len);
+    altitudes.reserve(decimated_len);
+    for (size_t i = 0; i < stage_2_data.size(); i += factor) {
+        times.push_back(stage_2_data.get_times()[i]);
+        velocities.push_back(stage_2_data.get_velocities()[i]);
+        altitudes.push_back(stage_2_data.get_altitudes()[i]);
+    }
+
+    decimation_result decimated;
+    double period = stage_2_data.get_sample_period();
+    if (period != 0 && !times.empty()) {
+        decimated.processed_data = {times[0], period * factor, std::move(velocities), std::move(altitudes)};
+    } else {
+        decimated.processed_data = {std::move(times), std::move(velocities), std::move(altitudes)};
+    }
+
+    // Only the kept outputs are computed
+    polyphase_decimator decimator{polyphase_decimator::design_lowpass(factor, DECIMATION_DELAY), factor};
+    std::vector<std::vector<double>> decimated_channels = decimator.transform_channels({v_stage_2.get_x(), v_stage_2.get_y()});
+    std::vector<double> x_velocities_decimated = std::move(decimated_channels[0]);
+    std::vector<double> y_velocities_decimated = std::move(decimated_channels[1]);
+
+    // Output m + DECIMATION_DELAY is centered on the stage 2
+    // velocity at index m * factor
+    array_view<const double> result_times = v_stage_2.get_times();
+    decimated.velocities.reserve(x_velocities_decimated.size());
+    for (size_t m = DECIMATION_DELAY; m < x_velocities_decimated.size(); ++m) {
+        double t = result_times[(m - DECIMATION_DELAY) * factor];
+        decimated.velocities.push_back(t, {x_velocities_decimated[m], y_velocities_decimated[m]});
+    }
+
+    return decimated;
+}
+
+pipeline_result run_pipeline(const telem_data &raw_data, const pipeline_options &options) {
+    pipeline_result result;
+    result.processed_data = prepare_stage_1_data(raw_data, options.grid, options.threads);
+    result.stage_1 = process_stage_1(result.processed_data);
+
+    velocity_series_view v_stage_1 = result.stage_1.velocities.view();
+    if (options.decimation_factor == 0 && options.lpf_type != stage_2_lpf::parks_mcclellan_zero_phase) {
+        fused_stage_outputs fused = fuse_stages_2_3(v_stage_1, result.processed_data,
+                                                    options.lpf_type, options.threads);
+        result.stage_2 = {std::move(fused.stage_2), std::move(fused.stage_2_velocity_errors), fused.altitude_errors};
+        result.stage_3 = {std::move(fused.stage_3),
+                          std::move(fused.stage_3_velocity_errors),
+                          std::move(fused.altitude_errors)};
+        result.stage_3_data = result.processed_data;
+
+        return result;
+    }
+
+    result.stage_2 = process_stage_2(v_stage_1, result.processed_data, options.lpf_type, options.threads);
+
+    velocity_series_view v_stage_2 = result.stage_2.velocities.view();
+    if (options.decimation_factor != 0) {
+        result.decimated = process_decimation(v_stage_2, result.processed_data, options.decimation_factor);
+        result.stage_3_data = result.decimated.processed_data;
+        v_stage_2 = result.decimated.velocities.view();
+    } else {
+        result.stage_3_data = result.processed_data;
+    }
+
+    result.stage_3 = process_stage_3(v_stage_2, result.stage_3_data, options.threads);
+
+    return result;
+}
+
+void append_csv_value(std::string &buffer, double value) {
+    // Shortest forms take at most 24 characters, as in
+    // -2.2250738585072014e-308
+    char digits[32];
+    std::to_chars_result res = std::to_chars(digits, digits + sizeof(digits), value);
+    buffer.append(digits, res.ptr);
+}
+
+/**
+ * Appends a row to the CSV buffer for each velocity of a
+ * stage.
+ *
+ * @param buffer the CSV text
+ * @param stage the label of the stage
+ * @param processed_data the processed telemetry data
+ * paired with the velocities
+ * @param velocities the velocities
+ * @param result the stage result with the errors, or
+ * nullptr to leave them empty
+ */
+static void append_stage_rows(std::string &buffer,
+                              const char *stage,
+                              const telem_data &processed_data,
+                              velocity_series_view velocities,
+                              const stage_result *result) {
+    array_view<const double> times = processed_data.get_times();
+    array_view<const double> x = velocities.get_x();
+    array_view<const double> y = velocities.get_y();
+    for (size_t i = 0; i < velocities.size(); ++i) {
+        buffer += stage;
+        buffer += ',';
+        append_csv_value(buffer, times[i]);
+        buffer += ',';
+        append_csv_value(buffer, x[i]);
+        buffer += ',';
+        append_csv_value(buffer, y[i]);
+        buffer += ',';
+        if (result != nullptr) {
+            append_csv_value(buffer, result->velocity_errors[i]);
+            buffer += ',';
+            append_csv_value(buffer, result->altitude_errors[i]);
+        } else {
+            buffer += ',';
+        }
+        buffer += '\n';
+    }
+}
+
+void format_pipeline_csv(const pipeline_result &result, std::string &buffer) {
+    buffer += PIPELINE_CSV_HEADER;
+    append_stage_rows(buffer, "1", result.processed_data, result.stage_1.velocities.view(), &result.stage_1);
+    append_stage_rows(buffer, "2", result.processed_data, result.stage_2.velocities.view(), &result.stage_2);
+    append_stage_rows(buffer, "2d", result.decimated.processed_data, result.decimated.velocities.view(), nullptr);
+    append_stage_rows(buffer, "3", result.stage_3_data, result.stage_3.velocities.view(), &result.stage_3);
+}
+
+void write_pipeline_csv(const pipeline_result &result, const std::string &file_path) {
+    // Formatting the whole file up front is much faster than
+    // streaming each value through the file
+    std::string buffer;
+    format_pipeline_csv(result, buffer);
+
+    csv_writer csv{file_path};
+    csv << buffer;
+}
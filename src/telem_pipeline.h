@@ -0,0 +1,345 @@
+/**
+ * @file
+ */
+
+#ifndef TELEM_FILTER_TELEM_PIPELINE_H
+#define TELEM_FILTER_TELEM_PIPELINE_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "signal_filter.h"
+#include "telem_data.h"
+#include "vector2d.h"
+#include "velocity_series.h"
+
+/**
+ * The time after which stage 1 stops extracting velocities,
+ * s.
+ */
+static const double STAGE_1_END_TIME = 200;
+
+/**
+ * The header row of the CSV files written from the outputs
+ * of the pipeline.
+ */
+static const char PIPELINE_CSV_HEADER[] = "stage,time,v_x,v_y,velocity_error,altitude_error\n";
+
+/**
+ * @brief The time grids on which stage 1 can process the
+ * telemetry.
+ */
+enum class stage_1_grid {
+    /**
+     * The original sample times, which are jittered.
+     */
+    raw,
+    /**
+     * A uniform grid at the nominal sample rate, onto which
+     * the samples are linearly interpolated.
+     */
+    uniform_linear,
+    /**
+     * A uniform grid at the nominal sample rate, onto which
+     * the samples are interpolated by cubic splines.
+     */
+    uniform_cubic
+};
+
+/**
+ * @brief The low-pass filter designs available to stage 2.
+ */
+enum class stage_2_lpf {
+    /**
+     * The 100-tap Parks-McClellan linear-phase FIR filter,
+     * which delays the velocities by 50 samples.
+     */
+    parks_mcclellan,
+    /**
+     * The Parks-McClellan filter applied forwards and
+     * backwards, which has no delay, so no velocities are
+     * dropped, but requires the whole flight up front.
+     */
+    parks_mcclellan_zero_phase,
+    /**
+     * A 4th order Butterworth IIR filter, which delays slow
+     * velocity changes by about 12 samples at a lower cost
+     * per sample, but not every frequency equally.
+     */
+    butterworth
+};
+
+/**
+ * @brief The outputs of one velocity processing stage.
+ *
+ * Every column has one element per velocity, which is
+ * paired with the processed telemetry data at the same
+ * index.
+ */
+struct stage_result {
+    /**
+     * The velocities produced by the stage.
+     */
+    velocity_series velocities;
+    /**
+     * The difference between the magnitude of each velocity
+     * and the telemetry velocity, m/s.
+     */
+    std::vector<double> velocity_errors;
+    /**
+     * The difference between the altitude from integrating
+     * the vertical velocities and the telemetry altitude,
+     * km.
+     */
+    std::vector<double> altitude_errors;
+};
+
+/**
+ * @brief The outputs of the decimation stage.
+ */
+struct decimation_result {
+    /**
+     * The processed telemetry data, reduced to the samples
+     * paired with the decimated velocities.
+     */
+    telem_data processed_data;
+    /**
+     * The decimated velocities.
+     */
+    velocity_series velocities;
+};
+
+/**
+ * @brief The options of a run of the whole pipeline.
+ */
+struct pipeline_options {
+    /**
+     * The time grid of stage 1.
+     */
+    stage_1_grid grid{stage_1_grid::raw};
+    /**
+     * The low-pass filter design of stage 2.
+     */
+    stage_2_lpf lpf_type{stage_2_lpf::parks_mcclellan};
+    /**
+     * The factor by which the stage 2 velocities are
+     * decimated before stage 3, or 0 to skip decimation.
+     */
+    unsigned int decimation_factor{0};
+    /**
+     * The maximum number of threads each step may use, or 0
+     * to use one thread per hardware core. Runs processing
+     * many flights at once should use 1.
+     */
+    unsigned int threads{0};
+};
+
+/**
+ * @brief The outputs of a run of the whole pipeline.
+ */
+struct pipeline_result {
+    /**
+     * The processed telemetry data of stages 1 and 2.
+     */
+    telem_data processed_data;
+    /**
+     * The outputs of stage 1.
+     */
+    stage_result stage_1;
+    /**
+     * The outputs of stage 2.
+     */
+    stage_result stage_2;
+    /**
+     * The decimated stage 2 velocities, which are empty if
+     * decimation was skipped.
+     */
+    decimation_result decimated;
+    /**
+     * The processed telemetry data of stage 3, which is the
+     * decimated data if decimation was not skipped.
+     */
+    telem_data stage_3_data;
+    /**
+     * The outputs of stage 3.
+     */
+    stage_result stage_3;
+};
+
+/**
+ * Loads telemetry data from a JSON file or, if the path
+ * ends in .telem, from a cache produced by telem_convert.
+ *
+ * @param file_path the path to the telemetry
+ * @param threads the maximum number of threads to parse
+ * the JSON with, or 0 to use one thread per hardware core
+ * @return the raw telemetry data
+ * @throws std::invalid_argument if the file cannot be read
+ */
+telem_data load_telemetry(const std::string &file_path, unsigned int threads = 0);
+
+/**
+ * Interpolates the altitude plateaus of the raw telemetry
+ * and resamples it onto the time grid of stage 1.
+ *
+ * @param raw_data the raw telemetry data
+ * @param grid the time grid
+ * @param threads the maximum number of threads to use, or
+ * 0 to use one thread per hardware core
+ * @return the processed telemetry data used by the stages
+ */
+telem_data prepare_stage_1_data(const telem_data &raw_data, stage_1_grid grid, unsigned int threads = 0);
+
+/**
+ * Adjusts the velocity vector to account for the rocket's
+ * pitch maneuver.
+ *
+ * @param v_mag the velocity magnitude, m/s
+ * @param alt_prev the prior altitude, km
+ * @param alt_next the altitude setpoint, km
+ * @param dt the time step, s
+ * @return the velocity components needed to reach the
+ * prescribed altitude with the given magnitude
+ */
+vector2d extract_velocity(double v_mag, double alt_prev, double alt_next, double dt);
+
+/**
+ * Extracts the initial velocity components from the
+ * processed telemetry, pitching the velocity over once it
+ * exceeds that needed to reach the next altitude.
+ *
+ * Each velocity depends on the altitude integrated from
+ * those before, so the extraction is serial. It stops after
+ * the first sample past 200 s.
+ *
+ * @param processed_data the processed telemetry data
+ * @return the outputs of stage 1
+ */
+stage_result process_stage_1(const telem_data &processed_data);
+
+/**
+ * Creates a stream processor which filters one channel of
+ * velocities by the given low-pass filter design.
+ *
+ * @param lpf_type the low-pass filter design
+ * @param filter_delay set to the number of samples by which
+ * the filter delays the velocities
+ * @return the filter
+ * @throws std::invalid_argument if the filter is
+ * zero-phase, which cannot be applied to a stream
+ */
+std::unique_ptr<signal_filter> make_stage_2_stream_lpf(stage_2_lpf lpf_type, unsigned int &filter_delay);
+
+/**
+ * Filters the velocities of stage 1 with a 1 Hz low-pass
+ * filter, dropping the velocities preceding the filter
+ * delay so that the rest line up with the telemetry.
+ *
+ * @param v_stage_1 the velocities of stage 1
+ * @param processed_data the processed telemetry data
+ * @param lpf_type the low-pass filter design
+ * @param threads the maximum number of threads to use, or
+ * 0 to use one thread per hardware core
+ * @return the outputs of stage 2
+ */
+stage_result process_stage_2(velocity_series_view v_stage_1,
+                             const telem_data &processed_data,
+                             stage_2_lpf lpf_type,
+                             unsigned int threads = 0);
+
+/**
+ * Adjusts a filtered velocity to the telemetry velocity by
+ * absorbing the velocity error into its horizontal
+ * component.
+ *
+ * @param v the telemetry velocity, m/s
+ * @param v_y_f the filtered vertical velocity, m/s
+ * @return the adjusted velocity, which keeps the filtered
+ * vertical velocity
+ */
+vector2d adjust_velocity(double v, double v_y_f);
+
+/**
+ * Adjusts the filtered velocities of stage 2, or of the
+ * decimation stage, to the telemetry velocity.
+ *
+ * @param v_stage_2 the filtered velocities
+ * @param processed_data the processed telemetry data paired
+ * with the filtered velocities
+ * @param threads the maximum number of threads to use, or
+ * 0 to use one thread per hardware core
+ * @return the outputs of stage 3
+ */
+stage_result process_stage_3(velocity_series_view v_stage_2,
+                             const telem_data &processed_data,
+                             unsigned int threads = 0);
+
+/**
+ * Reduces the velocities of stage 2 and their processed
+ * telemetry data to a lower rate with a polyphase
+ * decimator.
+ *
+ * @param v_stage_2 the velocities of stage 2
+ * @param stage_2_data the processed telemetry data of
+ * stage 2
+ * @param factor the downsampling factor
+ * @return the decimated velocities and telemetry data
+ * @throws std::invalid_argument if the factor is zero
+ */
+decimation_result process_decimation(velocity_series_view v_stage_2,
+                                      const telem_data &stage_2_data,
+                                      unsigned int factor);
+
+/**
+ * Runs every stage of the pipeline on the given telemetry
+ * at full speed, without plotting.
+ *
+ * Stages 2 and 3 are computed in a single fused pass when
+ * decimation is skipped and the filter is causal.
+ *
+ * @param raw_data the raw telemetry data
+ * @param options the options of the run
+ * @return the outputs of every stage
+ */
+pipeline_result run_pipeline(const telem_data &raw_data, const pipeline_options &options);
+
+/**
+ * Appends a value to CSV text in the shortest form that
+ * reads back to the same double.
+ *
+ * @param buffer the CSV text
+ * @param value the value to append
+ */
+void append_csv_value(std::string &buffer, double value);
+
+/**
+ * Formats the outputs of every velocity stage of a pipeline
+ * run as CSV, one row per velocity.
+ *
+ * The columns are the stage, which is one of 1, 2, 2d for
+ * the decimated velocities, or 3, the time of the paired
+ * telemetry sample, the velocity components and the
+ * velocity and altitude errors, which are empty for the
+ * decimated velocities. Values are written in the shortest
+ * form that reads back to the same double.
+ *
+ * @param result the outputs of the run
+ * @param buffer the text to which the CSV is appended,
+ * which can be reused between runs to keep its capacity
+ */
+void format_pipeline_csv(const pipeline_result &result, std::string &buffer);
+
+/**
+ * Writes the outputs of every velocity stage of a pipeline
+ * run to a CSV file, as formatted by
+ * format_pipeline_csv().
+ *
+ * @param result the outputs of the run
+ * @param file_path the path to the CSV file to write
+ * @throws std::invalid_argument if the file cannot be
+ * opened
+ */
+void write_pipeline_csv(const pipeline_result &result, const std::string &file_path);
+
+#endif // TELEM_FILTER_TELEM_PIPELINE_H
@@ -0,0 +1,479 @@
+#include "telem_server.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "telem_json_parser.h"
+
+static_assert(sizeof(server_sample_record) == 3 * sizeof(double), "Sample records must not be padded");
+static_assert(sizeof(server_velocity_record) == 5 * sizeof(double), "Velocity records must not be padded");
+
+/**
+ * The number of bytes read from a client at a time.
+ */
+static const size_t SERVER_READ_SIZE = 64 * 1024;
+
+/**
+ * The longest request line accepted from a new client.
+ */
+static const size_t MAX_REQUEST_SIZE = 256;
+
+/**
+ * Determines whether an address names a TCP port rather
+ * than a socket path.
+ *
+ * @param listen_address the address
+ * @return true if the address is a port number
+ */
+static bool is_port(const std::string &listen_address) {
+    return !listen_address.empty() && listen_address.size() <= 5
+           && listen_address.find_first_not_of("0123456789") == std::string::npos;
+}
+
+/**
+ * Makes a socket non-blocking.
+ *
+ * @param fd the socket
+ * @return true on success
+ */
+static bool set_non_blocking(int fd) {
+    int flags = fcntl(fd, F_GETFL);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+telem_server::telem_server(const std::string &listen_address, thread_pool &pool, stage_2_lpf lpf_type) :
+        engine(pool, [this](stream_engine::stream_id stream, stream_outputs &outputs) {
+            complete(stream, outputs);
+        }, lpf_type) {
+    if (is_port(listen_address)) {
+        unsigned long port = std::stoul(listen_address);
+        if (port > 65535) {
+            throw std::invalid_argument{"Port must be at most 65535."};
+        }
+
+        listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (listen_fd < 0) {
+            throw std::invalid_argument{"Socket could not be created."};
+        }
+
+        int reuse = 1;
+        setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        // Only the loopback interface is served, as the
+        // protocol has no authentication
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t addr_len = sizeof(addr);
+        if (bind(listen_fd, reinterpret_cast<sockaddr *>(&addr), addr_len) != 0
+            || getsockname(listen_fd, reinterpret_cast<sockaddr *>(&addr), &addr_len) != 0) {
+            close(listen_fd);
+            throw std::invalid_argument{"Socket could not be bound."};
+        }
+        address = "127.0.0.1:" + std::to_string(ntohs(addr.sin_port));
+    } else {
+        sockaddr_un addr{};
+        if (listen_address.size() >= sizeof(addr.sun_path)) {
+            throw std::invalid_argument{"Socket path is too long."};
+        }
+
+        listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (listen_fd < 0) {
+            throw std::invalid_argument{"Socket could not be created."};
+        }
+
+        // Replace a socket left behind by a server which did
+        // not shut down, but never any other file
+        struct stat st{};
+        if (lstat(listen_address.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+            unlink(listen_address.c_str());
+        }
+
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, listen_address.c_str(), listen_address.size() + 1);
+        if (bind(listen_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+            close(listen_fd);
+            throw std::invalid_argument{"Socket could not be bound."};
+        }
+        socket_path = listen_address;
+        address = listen_address;
+    }
+
+    // The workers write to the pipe to wake the server once
+    // they have completed velocities
+    if (listen(listen_fd, SOMAXCONN) != 0 || !set_non_blocking(listen_fd)
+        || pipe2(wake_fds, O_NONBLOCK | O_CLOEXEC) != 0) {
+        close(listen_fd);
+        if (!socket_path.empty()) {
+            unlink(socket_path.c_str());
+        }
+        throw std::invalid_argument{"Socket could not be listened on."};
+    }
+}
+
+telem_server::~telem_server() {
+    // The streams still running wake the server through the
+    // pipe, so must finish before it is closed
+    engine.wait();
+    close(wake_fds[0]);
+    close(wake_fds[1]);
+
+    for (const client &c : clients) {
+        close(c.fd);
+    }
+    close(listen_fd);
+    if (!socket_path.empty()) {
+        unlink(socket_path.c_str());
+    }
+}
+
+void telem_server::accept_client() {
+    while (true) {
+        int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+
+        // Send each published velocity as soon as it is
+        // queued, rather than coalescing small writes
+        if (socket_path.empty()) {
+            int no_delay = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+        }
+
+        clients.emplace_back();
+        clients.back().fd = fd;
+    }
+}
+
+void telem_server::receive(client &c) {
+    bool ended = false;
+    char buffer[SERVER_READ_SIZE];
+    while (true) {
+        ssize_t count = read(c.fd, buffer, sizeof(buffer));
+        if (count > 0) {
+            // Subscribers send nothing after their request
+            if (c.role != client_role::subscriber) {
+                c.input.append(buffer, count);
+            }
+            continue;
+        }
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+
+        ended = count == 0 || (errno != EAGAIN && errno != EWOULDBLOCK);
+        break;
+    }
+
+    if (c.role == client_role::pending) {
+        size_t request_end = c.input.find('\n');
+        if (request_end == std::string::npos) {
+            if (ended) {
+                c.closed = true;
+            } else if (c.input.size() > MAX_REQUEST_SIZE) {
+                reject(c, "error: request is too long");
+            }
+            return;
+        }
+
+        std::string request = c.input.substr(0, request_end);
+        c.input.erase(0, request_end + 1);
+        handle_request(c, request);
+    }
+
+    if (c.role == client_role::producer) {
+        try {
+            consume(c, ended);
+        } catch (const std::exception &e) {
+            std::cerr << "Dropping producer: " << e.what() << std::endl;
+            reject(c, std::string{"error: "} + e.what());
+        }
+    }
+
+    if (ended) {
+        c.closed = true;
+    }
+}
+
+/**
+ * Parses the identifier of a stream in a request.
+ *
+ * @param word the word of the request
+ * @param id set to the identifier
+ * @return true if the word is a valid identifier
+ */
+static bool parse_stream_id(const std::string &word, stream_engine::stream_id &id) {
+    if (word.empty() || word.size() > 10 || word.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+
+    unsigned long long value = std::stoull(word);
+    id = static_cast<stream_engine::stream_id>(value);
+
+    return value == id;
+}
+
+void telem_server::handle_request(client &c, const std::string &request) {
+    std::istringstream stream{request};
+    std::vector<std::string> words{std::istream_iterator<std::string>{stream}, std::istream_iterator<std::string>{}};
+
+    bool binary = words.size() >= 2 && words[1] == "binary";
+    bool known_format = words.size() >= 2 && (binary || words[1] == "json");
+    stream_engine::stream_id id = 0;
+
+    if (known_format && words[0] == "publish" && words.size() <= 3
+        && (words.size() == 2 || parse_stream_id(words[2], id))) {
+        if (!producer_streams.insert(id).second) {
+            reject(c, "error: stream " + std::to_string(id) + " already has a producer");
+            return;
+        }
+
+        c.role = client_role::producer;
+        c.binary = binary;
+        c.stream = id;
+    } else if (known_format && words[0] == "subscribe" && words.size() <= 4
+               && (words.size() == 2 || (words[2].size() == 1 && words[2][0] >= '1' && words[2][0] <= '3'))
+               && (words.size() <= 3 || parse_stream_id(words[3], id))) {
+        c.role = client_role::subscriber;
+        c.binary = binary;
+        c.stage = words.size() >= 3 ? words[2][0] - '0' : 3;
+        c.stream = id;
+        c.input.clear();
+        c.input.shrink_to_fit();
+    } else {
+        reject(c, "error: unknown request");
+    }
+}
+
+void telem_server::consume(client &c, bool ended) {
+    samples.clear();
+    if (c.binary) {
+        size_t count = c.input.size() / sizeof(server_sample_record);
+        samples.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            server_sample_record record;
+            std::memcpy(&record, c.input.data() + i * sizeof(record), sizeof(record));
+            samples[i] = {record.time, record.velocity, record.altitude};
+        }
+        c.input.erase(0, count * sizeof(server_sample_record));
+    } else {
+        size_t last_line_end = c.input.rfind('\n');
+        if (last_line_end != std::string::npos) {
+            telem_json_parser::parse_lines(c.input.data(), c.input.data() + last_line_end, samples);
+            c.input.erase(0, last_line_end + 1);
+        }
+
+        // The producer may have ended without terminating its
+        // last line
+        if (ended && c.input.find_first_not_of(" \t\r") != std::string::npos) {
+            samples.push_back(telem_json_parser::parse_line(c.input.data(), c.input.data() + c.input.size()));
+        }
+    }
+
+    engine.push(c.stream, samples);
+}
+
+void telem_server::complete(stream_engine::stream_id stream, stream_outputs &outputs) {
+    std::scoped_lock<std::mutex> lock{completed_mutex};
+
+    // One wakeup covers every velocity completed before the
+    // server takes them
+    if (completed.empty()) {
+        char wakeup = 0;
+        (void) write(wake_fds[1], &wakeup, 1);
+    }
+    completed.push_back({stream, std::move(outputs)});
+}
+
+void telem_server::receive_outputs() {
+    char wakeups[64];
+    while (read(wake_fds[0], wakeups, sizeof(wakeups)) > 0) {
+    }
+
+    {
+        std::scoped_lock<std::mutex> lock{completed_mutex};
+        completed.swap(publishing);
+    }
+
+    for (completed_outputs &outputs : publishing) {
+        publish(outputs.stream, outputs.outputs);
+    }
+    publishing.clear();
+}
+
+/**
+ * Appends a velocity to the output of a subscriber as a
+ * JSON line.
+ *
+ * @param buffer the output
+ * @param stage the stage of the velocity
+ * @param sample the velocity
+ */
+static void append_json_velocity(std::string &buffer, int stage, const stage_sample &sample) {
+    buffer += "{\"stage\": ";
+    buffer += static_cast<char>('0' + stage);
+    buffer += ", \"time\": ";
+    append_csv_value(buffer, sample.time);
+    buffer += ", \"v_x\": ";
+    append_csv_value(buffer, sample.velocity.get_x());
+    buffer += ", \"v_y\": ";
+    append_csv_value(buffer, sample.velocity.get_y());
+    buffer += ", \"velocity_error\": ";
+    append_csv_value(buffer, sample.velocity_error);
+    buffer += ", \"altitude_error\": ";
+    append_csv_value(buffer, sample.altitude_error);
+    buffer += "}\n";
+}
+
+/**
+ * Appends a velocity to the output of a subscriber as a
+ * binary record.
+ *
+ * @param buffer the output
+ * @param sample the velocity
+ */
+static void append_binary_velocity(std::string &buffer, const stage_sample &sample) {
+    server_velocity_record record{sample.time, sample.velocity.get_x(), sample.velocity.get_y(),
+                                  sample.velocity_error, sample.altitude_error};
+    buffer.append(reinterpret_cast<const char *>(&record), sizeof(record));
+}
+
+void telem_server::publish(stream_engine::stream_id stream, const stream_outputs &outputs) {
+    const std::vector<stage_sample> *stages[3]{&outputs.stage_1, &outputs.stage_2, &outputs.stage_3};
+
+    // Each stage is formatted once in each format, and only
+    // if it has a subscriber
+    for (client &c : clients) {
+        if (c.role != client_role::subscriber || c.closed || c.stream != stream || stages[c.stage - 1]->empty()) {
+            continue;
+        }
+
+        std::string &text = formatted[c.binary][c.stage - 1];
+        if (text.empty()) {
+            for (const stage_sample &sample : *stages[c.stage - 1]) {
+                if (c.binary) {
+                    append_binary_velocity(text, sample);
+                } else {
+                    append_json_velocity(text, c.stage, sample);
+                }
+            }
+        }
+
+        if (c.output.size() + text.size() > MAX_SUBSCRIBER_BACKLOG) {
+            std::cerr << "Dropping subscriber which fell behind." << std::endl;
+            c.closed = true;
+            continue;
+        }
+        c.output += text;
+        send_output(c);
+    }
+
+    for (auto &format : formatted) {
+        for (std::string &text : format) {
+            text.clear();
+        }
+    }
+}
+
+void telem_server::send_output(client &c) {
+    size_t sent = 0;
+    while (sent < c.output.size()) {
+        ssize_t count = send(c.fd, c.output.data() + sent, c.output.size() - sent, MSG_NOSIGNAL);
+        if (count > 0) {
+            sent += count;
+        } else if (count < 0 && errno == EINTR) {
+            continue;
+        } else {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                c.closed = true;
+            }
+            break;
+        }
+    }
+
+    c.output.erase(0, sent);
+}
+
+void telem_server::reject(client &c, const std::string &message) {
+    c.output += message;
+    c.output += '\n';
+    send_output(c);
+    c.closed = true;
+}
+
+void telem_server::run(const volatile std::sig_atomic_t &stop) {
+    std::vector<pollfd> fds;
+    while (!stop) {
+        fds.clear();
+        fds.push_back({listen_fd, POLLIN, 0});
+        fds.push_back({wake_fds[0], POLLIN, 0});
+        for (const client &c : clients) {
+            fds.push_back({c.fd, static_cast<short>(c.output.empty() ? POLLIN : POLLIN | POLLOUT), 0});
+        }
+
+        if (poll(fds.data(), fds.size(), SERVER_WAIT_TIMEOUT) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::invalid_argument{"Sockets could not be waited on."};
+        }
+
+        if (fds[1].revents & POLLIN) {
+            receive_outputs();
+        }
+
+        // The clients are only added to after they have been
+        // served, so that their poll results stay aligned
+        for (size_t i = 0; i < clients.size(); ++i) {
+            client &c = clients[i];
+            short events = fds[i + 2].revents;
+            if (events & POLLOUT) {
+                send_output(c);
+            }
+            if (events & (POLLIN | POLLHUP | POLLERR)) {
+                receive(c);
+            }
+        }
+
+        // However a producer disconnects, its stream is ended
+        // so that the held back samples are still published
+        for (const client &c : clients) {
+            if (c.closed && c.role == client_role::producer) {
+                engine.end(c.stream);
+                producer_streams.erase(c.stream);
+            }
+        }
+        auto closed = std::stable_partition(clients.begin(), clients.end(), [](const client &c) {
+            return !c.closed;
+        });
+        for (auto it = closed; it != clients.end(); ++it) {
+            close(it->fd);
+        }
+        clients.erase(closed, clients.end());
+
+        if (fds[0].revents & POLLIN) {
+            accept_client();
+        }
+    }
+}
+
+const std::string &telem_server::get_address() const {
+    return address;
+}
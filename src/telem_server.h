@@ -0,0 +1,360 @@
+/**
+ * @file
+ */
+
+#ifndef TELEM_FILTER_TELEM_SERVER_H
+#define TELEM_FILTER_TELEM_SERVER_H
+
+#include <csignal>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "stream_engine.h"
+#include "stream_pipeline.h"
+#include "telem_data.h"
+#include "thread_pool.h"
+
+/**
+ * The most output queued for a subscriber which is not
+ * reading it, in bytes, before the subscriber is dropped.
+ */
+static const size_t MAX_SUBSCRIBER_BACKLOG = 4 * 1024 * 1024;
+
+/**
+ * The longest the server waits for activity before checking
+ * whether to stop, ms.
+ */
+static const int SERVER_WAIT_TIMEOUT = 250;
+
+/**
+ * @brief The binary form of a telemetry sample sent by a
+ * producer, in the byte order of the machine.
+ */
+struct server_sample_record {
+    /**
+     * The time offset, s.
+     */
+    double time;
+    /**
+     * The velocity magnitude, m/s.
+     */
+    double velocity;
+    /**
+     * The altitude, km.
+     */
+    double altitude;
+};
+
+/**
+ * @brief The binary form of a velocity published to a
+ * subscriber, in the byte order of the machine.
+ */
+struct server_velocity_record {
+    /**
+     * The time of the telemetry sample paired with the
+     * velocity, s.
+     */
+    double time;
+    /**
+     * The X velocity, m/s.
+     */
+    double v_x;
+    /**
+     * The Y velocity, m/s.
+     */
+    double v_y;
+    /**
+     * The difference between the magnitude of the velocity
+     * and the telemetry velocity, m/s.
+     */
+    double velocity_error;
+    /**
+     * The difference between the integrated and telemetry
+     * altitudes, km.
+     */
+    double altitude_error;
+};
+
+/**
+ * @brief Serves the processing stages over a Unix domain
+ * socket, or a TCP port on the loopback interface.
+ *
+ * Each client starts by sending one request line, where the
+ * stream defaults to 0:
+ *
+ * - `publish json [stream]` sends telemetry lines in the
+ *   format of the telemetry files
+ * - `publish binary [stream]` sends server_sample_record
+ *   structures
+ * - `subscribe json [1|2|3 [stream]]` receives the
+ *   velocities of a stage of a stream, stage 3 by default,
+ *   as JSON lines with the columns of write_pipeline_csv()
+ * - `subscribe binary [1|2|3 [stream]]` receives them as
+ *   server_velocity_record structures
+ *
+ * Each stream has one producer at a time, whose samples are
+ * run through the stages by a stream_engine, and each
+ * velocity is published to every subscriber of its stream
+ * and stage as soon as the sample completing it has been
+ * processed. When the producer disconnects, the held back
+ * samples are processed and the stream is ended, so that
+ * the next producer starts a new flight.
+ *
+ * The sockets are served on a single thread, waiting on
+ * every socket with poll(), while the streams run on the
+ * pool, which wakes the server through a pipe once it has
+ * completed velocities. Subscribers which fall behind are
+ * dropped rather than delaying the others.
+ */
+class telem_server {
+private:
+    /**
+     * @brief The role a client requested.
+     */
+    enum class client_role {
+        /**
+         * The request line has not yet been received.
+         */
+        pending,
+        /**
+         * The client sends telemetry.
+         */
+        producer,
+        /**
+         * The client receives velocities.
+         */
+        subscriber
+    };
+
+    /**
+     * @brief A connected client.
+     */
+    struct client {
+        /**
+         * The socket of the client.
+         */
+        int fd{-1};
+        /**
+         * The role of the client.
+         */
+        client_role role{client_role::pending};
+        /**
+         * Whether the client sends or receives binary
+         * records, rather than JSON lines.
+         */
+        bool binary{false};
+        /**
+         * The stage whose velocities a subscriber receives,
+         * from 1 to 3.
+         */
+        int stage{3};
+        /**
+         * The bytes received which have not yet been parsed.
+         */
+        std::string input;
+        /**
+         * The bytes queued for the client which have not yet
+         * been sent.
+         */
+        std::string output;
+        /**
+         * The stream which the client sends or receives.
+         */
+        stream_engine::stream_id stream{0};
+        /**
+         * Whether the client is to be disconnected.
+         */
+        bool closed{false};
+    };
+
+    /**
+     * @brief The velocities completed for a stream, waiting
+     * to be published.
+     */
+    struct completed_outputs {
+        /**
+         * The stream.
+         */
+        stream_engine::stream_id stream;
+        /**
+         * The velocities.
+         */
+        stream_outputs outputs;
+    };
+
+    /**
+     * The listening socket.
+     */
+    int listen_fd{-1};
+    /**
+     * The path of the Unix domain socket, or empty if
+     * listening on TCP.
+     */
+    std::string socket_path;
+    /**
+     * The address being listened on, for display.
+     */
+    std::string address;
+    /**
+     * The connected clients.
+     */
+    std::vector<client> clients;
+    /**
+     * The streams which have a producer connected.
+     */
+    std::set<stream_engine::stream_id> producer_streams;
+    /**
+     * The samples parsed from the last read of a producer.
+     */
+    std::vector<telem_sample> samples;
+
+    /**
+     * The pipe written to by the workers to wake the server,
+     * read from then written to.
+     */
+    int wake_fds[2]{-1, -1};
+    /**
+     * The mutex used to protect access to the completed
+     * velocities.
+     */
+    std::mutex completed_mutex;
+    /**
+     * The velocities completed by the workers which the
+     * server has not yet taken.
+     */
+    std::vector<completed_outputs> completed;
+    /**
+     * The velocities taken by the server to publish.
+     */
+    std::vector<completed_outputs> publishing;
+    /**
+     * The engine running the stages on every stream, which
+     * is destroyed before the velocities it completes.
+     */
+    stream_engine engine;
+    /**
+     * The velocities of each stage formatted as JSON lines,
+     * then as binary records.
+     */
+    std::string formatted[2][3];
+
+    /**
+     * Accepts a pending connection.
+     */
+    void accept_client();
+
+    /**
+     * Reads the data sent by a client and handles the
+     * requests or samples it completes.
+     *
+     * @param c the client
+     */
+    void receive(client &c);
+
+    /**
+     * Handles the request line of a new client.
+     *
+     * @param c the client
+     * @param request the request line
+     */
+    void handle_request(client &c, const std::string &request);
+
+    /**
+     * Parses the samples a producer has completed and pushes
+     * them to its stream.
+     *
+     * @param c the producer
+     * @param ended whether the producer has disconnected, so
+     * that an unterminated last line is parsed
+     */
+    void consume(client &c, bool ended);
+
+    /**
+     * Queues the velocities completed for a stream to be
+     * published, waking the server. Called by the workers.
+     *
+     * @param stream the stream
+     * @param outputs the velocities, which are moved from
+     */
+    void complete(stream_engine::stream_id stream, stream_outputs &outputs);
+
+    /**
+     * Publishes the velocities completed by the workers.
+     */
+    void receive_outputs();
+
+    /**
+     * Publishes the velocities of a stream to the
+     * subscribers of their stages.
+     *
+     * @param stream the stream
+     * @param outputs the velocities
+     */
+    void publish(stream_engine::stream_id stream, const stream_outputs &outputs);
+
+    /**
+     * Sends as much of the queued output of a client as the
+     * socket accepts.
+     *
+     * @param c the client
+     */
+    void send_output(client &c);
+
+    /**
+     * Queues a message for a client and disconnects it once
+     * sent, on a best effort basis.
+     *
+     * @param c the client
+     * @param message the message line
+     */
+    void reject(client &c, const std::string &message);
+
+public:
+    /**
+     * Starts listening for clients.
+     *
+     * @param listen_address the path of the Unix domain
+     * socket, or a port number to listen on the loopback
+     * interface, 0 choosing a free port
+     * @param pool the pool on which to run the streams,
+     * which must outlive the server
+     * @param lpf_type the low-pass filter design of stage 2
+     * @throws std::invalid_argument if the filter is
+     * zero-phase or the socket cannot be listened on
+     */
+    telem_server(const std::string &listen_address,
+                 thread_pool &pool,
+                 stage_2_lpf lpf_type = stage_2_lpf::parks_mcclellan);
+
+    /**
+     * Waits for the streams to finish running, then
+     * disconnects every client and stops listening.
+     */
+    ~telem_server();
+
+    telem_server(const telem_server &) = delete;
+
+    telem_server &operator=(const telem_server &) = delete;
+
+    /**
+     * Serves clients until asked to stop.
+     *
+     * @param stop set to a non-zero value, such as by a
+     * signal handler, to stop serving
+     * @throws std::invalid_argument if the sockets cannot be
+     * waited on
+     */
+    void run(const volatile std::sig_atomic_t &stop);
+
+    /**
+     * Obtains the address being listened on.
+     *
+     * @return the socket path, or the loopback address and
+     * port
+     */
+    [[nodiscard]] const std::string &get_address() const;
+};
+
+#endif // TELEM_FILTER_TELEM_SERVER_H
@@ -0,0 +1,125 @@
+#include "telem_tail.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+#include "telem_json_parser.h"
+
+/**
+ * The number of bytes read from the file at a time.
+ */
+static const size_t TAIL_READ_SIZE = 64 * 1024;
+
+telem_tail::telem_tail(const std::string &file_path, bool watch) {
+    fd = open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::invalid_argument{"File could not be opened."};
+    }
+
+#ifdef __linux__
+    if (watch) {
+        // Fall back to polling if the file cannot be watched,
+        // such as on some network file systems
+        watch_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (watch_fd >= 0 && inotify_add_watch(watch_fd, file_path.c_str(), IN_MODIFY | IN_CLOSE_WRITE) < 0) {
+            close(watch_fd);
+            watch_fd = -1;
+        }
+    }
+#endif
+}
+
+telem_tail::~telem_tail() {
+    if (watch_fd >= 0) {
+        close(watch_fd);
+    }
+    close(fd);
+}
+
+size_t telem_tail::read(std::vector<telem_sample> &samples) {
+    struct stat st{};
+    if (fstat(fd, &st) != 0) {
+        throw std::invalid_argument{"File could not be read."};
+    }
+    if (static_cast<size_t>(st.st_size) < offset) {
+        throw std::invalid_argument{"Followed file was truncated."};
+    }
+
+    // Read onto the end of the partial line, so that it is
+    // completed in place
+    while (true) {
+        size_t len = partial.size();
+        partial.resize(len + TAIL_READ_SIZE);
+        ssize_t count = pread(fd, &partial[len], TAIL_READ_SIZE, static_cast<off_t>(offset));
+        if (count < 0) {
+            partial.resize(len);
+            throw std::invalid_argument{"File could not be read."};
+        }
+
+        partial.resize(len + count);
+        offset += count;
+        if (count == 0) {
+            break;
+        }
+    }
+
+    // The partial line never holds a terminator, so any
+    // found completes new lines
+    size_t last_line_end = partial.rfind('\n');
+    if (last_line_end == std::string::npos) {
+        return 0;
+    }
+
+    size_t before = samples.size();
+    telem_json_parser::parse_lines(partial.data(), partial.data() + last_line_end, samples);
+    partial.erase(0, last_line_end + 1);
+
+    return samples.size() - before;
+}
+
+size_t telem_tail::flush(std::vector<telem_sample> &samples) {
+    if (partial.find_first_not_of(" \t\r") == std::string::npos) {
+        partial.clear();
+        return 0;
+    }
+
+    samples.push_back(telem_json_parser::parse_line(partial.data(), partial.data() + partial.size()));
+    partial.clear();
+
+    return 1;
+}
+
+void telem_tail::wait(int timeout) {
+    if (watch_fd < 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{std::min(timeout, TAIL_POLL_INTERVAL)});
+        return;
+    }
+
+#ifdef __linux__
+    pollfd watch{watch_fd, POLLIN, 0};
+    if (poll(&watch, 1, timeout) <= 0) {
+        return;
+    }
+
+    // Only the wakeup matters, so drain the events without
+    // decoding them
+    alignas(inotify_event) char events[4096];
+    while (::read(watch_fd, events, sizeof(events)) > 0) {
+    }
+#endif
+}
+
+bool telem_tail::is_watched() const {
+    return watch_fd >= 0;
+}
@@ -0,0 +1,114 @@
+/**
+ * @file
+ */
+
+#ifndef TELEM_FILTER_TELEM_TAIL_H
+#define TELEM_FILTER_TELEM_TAIL_H
+
+#include <string>
+#include <vector>
+
+#include "telem_data.h"
+
+/**
+ * The interval at which a followed file is checked for new
+ * data when it cannot be watched, ms.
+ */
+static const int TAIL_POLL_INTERVAL = 100;
+
+/**
+ * @brief Follows a telemetry file which is being appended
+ * to, parsing the lines added since the last read.
+ *
+ * Only complete lines are parsed. The bytes after the last
+ * line terminator are held until the rest of their line is
+ * appended. Changes to the file are awaited through inotify
+ * where it is available, and otherwise by polling its size.
+ */
+class telem_tail {
+private:
+    /**
+     * The descriptor of the followed file.
+     */
+    int fd{-1};
+    /**
+     * The inotify descriptor watching the file, or -1 if
+     * the file is polled.
+     */
+    int watch_fd{-1};
+    /**
+     * The number of bytes of the file read so far.
+     */
+    size_t offset{0};
+    /**
+     * The bytes read after the last line terminator, which
+     * new data is read onto the end of.
+     */
+    std::string partial;
+
+public:
+    /**
+     * Opens the file at the given path to follow from its
+     * start.
+     *
+     * @param file_path the path to the telemetry file
+     * @param watch whether to watch the file with inotify,
+     * rather than polling it
+     * @throws std::invalid_argument if the file cannot be
+     * opened
+     */
+    explicit telem_tail(const std::string &file_path, bool watch = true);
+
+    /**
+     * Closes the file.
+     */
+    ~telem_tail();
+
+    telem_tail(const telem_tail &) = delete;
+
+    telem_tail &operator=(const telem_tail &) = delete;
+
+    /**
+     * Reads the data appended since the last read and parses
+     * the lines it completes.
+     *
+     * @param samples the vector to which the parsed samples
+     * are appended in file order
+     * @return the number of samples appended
+     * @throws std::invalid_argument if the file cannot be
+     * read or has been truncated
+     * @throws nlohmann::json::exception if a line cannot be
+     * parsed
+     */
+    size_t read(std::vector<telem_sample> &samples);
+
+    /**
+     * Parses the bytes held after the last line terminator
+     * as a final line, for a file whose writer has finished
+     * without terminating it.
+     *
+     * @param samples the vector to which the parsed sample
+     * is appended
+     * @return the number of samples appended
+     * @throws nlohmann::json::exception if the line cannot be
+     * parsed
+     */
+    size_t flush(std::vector<telem_sample> &samples);
+
+    /**
+     * Blocks until the file may have changed or the timeout
+     * expires. Polling waits at most the poll interval.
+     *
+     * @param timeout the maximum time to wait, ms
+     */
+    void wait(int timeout);
+
+    /**
+     * Determines whether the file is watched with inotify.
+     *
+     * @return true if watched, false if polled
+     */
+    [[nodiscard]] bool is_watched() const;
+};
+
+#endif // TELEM_FILTER_TELEM_TAIL_H
@@ -0,0 +1,128 @@
+#include "thread_pool.h"
+
+#include <stdexcept>
+
+/**
+ * The pool whose worker is the current thread, if any.
+ */
+static thread_local const thread_pool *current_pool = nullptr;
+
+/**
+ * The index of the worker that is the current thread, if
+ * it belongs to a pool.
+ */
+static thread_local size_t current_index = 0;
+
+thread_pool::thread_pool(size_t threads) {
+    if (threads == 0) {
+        throw std::invalid_argument{"Thread pool must have at least one worker."};
+    }
+
+    queues.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        queues.push_back(std::make_unique<worker_queue>());
+    }
+
+    workers.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers.emplace_back(&thread_pool::work, this, i);
+    }
+}
+
+thread_pool::~thread_pool() {
+    {
+        std::lock_guard<std::mutex> lock{sleep_mutex};
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+}
+
+size_t thread_pool::size() const {
+    return workers.size();
+}
+
+void thread_pool::submit(std::function<void()> task) {
+    size_t index;
+    if (current_pool == this) {
+        index = current_index;
+    } else {
+        index = next_queue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    }
+
+    // Counted before it is queued so the count cannot drop
+    // below zero when the task is taken straight away
+    queued.fetch_add(1, std::memory_order_release);
+    {
+        worker_queue &queue = *queues[index];
+        std::lock_guard<std::mutex> lock{queue.mutex};
+        queue.tasks.push_back(std::move(task));
+    }
+
+    // Idle workers check the count while holding the sleep
+    // mutex, so taking it here means none can miss the task
+    {
+        std::lock_guard<std::mutex> lock{sleep_mutex};
+    }
+    wake.notify_one();
+}
+
+bool thread_pool::pop_local(size_t index, std::function<void()> &task) {
+    worker_queue &queue = *queues[index];
+    std::lock_guard<std::mutex> lock{queue.mutex};
+    if (queue.tasks.empty()) {
+        return false;
+    }
+
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    queued.fetch_sub(1, std::memory_order_relaxed);
+
+    return true;
+}
+
+bool thread_pool::steal(size_t index, std::function<void()> &task) {
+    size_t count = queues.size();
+    for (size_t k = 1; k < count; ++k) {
+        worker_queue &queue = *queues[(index + k) % count];
+        std::lock_guard<std::mutex> lock{queue.mutex};
+        if (queue.tasks.empty()) {
+            continue;
+        }
+
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        queued.fetch_sub(1, std::memory_order_relaxed);
+
+        return true;
+    }
+
+    return false;
+}
+
+void thread_pool::work(size_t index) {
+    current_pool = this;
+    current_index = index;
+
+    std::function<void()> task;
+    while (true) {
+        if (pop_local(index, task) || steal(index, task)) {
+            task();
+            task = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock{sleep_mutex};
+        wake.wait(lock, [this]() {
+            return stopping || queued.load(std::memory_order_acquire) != 0;
+        });
+
+        // Queued tasks are still run when stopping
+        if (stopping && queued.load(std::memory_order_acquire) == 0) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,154 @@
+/**
+ * @file
+ */
+
+#ifndef TELEM_FILTER_THREAD_POOL_H
+#define TELEM_FILTER_THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief A fixed number of worker threads which run tasks
+ * submitted from any thread, balancing them by work
+ * stealing.
+ *
+ * Every worker has its own queue of tasks. Tasks submitted
+ * by a worker go to the back of its own queue and are run
+ * from the back, so a chain of dependent tasks stays on one
+ * thread while its data is still in cache. Tasks submitted
+ * by other threads are dealt to the queues in turn. A
+ * worker whose queue is empty steals from the front of the
+ * other queues, taking the oldest tasks, and sleeps only
+ * once every queue is empty.
+ */
+class thread_pool {
+private:
+    /**
+     * @brief The queue of tasks of one worker.
+     */
+    struct worker_queue {
+        /**
+         * The mutex used to protect access to the tasks.
+         */
+        std::mutex mutex;
+        /**
+         * The tasks, taken from the back by the owning
+         * worker and from the front by stealing workers.
+         */
+        std::deque<std::function<void()>> tasks;
+    };
+
+    /**
+     * The queue of each worker.
+     */
+    std::vector<std::unique_ptr<worker_queue>> queues;
+    /**
+     * The worker threads.
+     */
+    std::vector<std::thread> workers;
+
+    /**
+     * The number of tasks submitted but not yet taken from
+     * a queue.
+     */
+    std::atomic<size_t> queued{0};
+    /**
+     * The queue to which the next task submitted from
+     * outside the pool is dealt.
+     */
+    std::atomic<size_t> next_queue{0};
+
+    /**
+     * Whether the pool is being destroyed.
+     *
+     * Access to this member is protected by the sleep
+     * mutex.
+     */
+    bool stopping{false};
+    /**
+     * The mutex used by idle workers to wait for tasks.
+     */
+    std::mutex sleep_mutex;
+    /**
+     * The condition variable used to wake idle workers.
+     */
+    std::condition_variable wake;
+
+    /**
+     * Takes the task most recently pushed to the queue of
+     * the given worker.
+     *
+     * @param index the index of the worker
+     * @param task set to the task taken
+     * @return true if a task was taken, false if the queue
+     * is empty
+     */
+    bool pop_local(size_t index, std::function<void()> &task);
+
+    /**
+     * Takes the oldest task of the first other worker with
+     * any, starting from the worker after the given one.
+     *
+     * @param index the index of the stealing worker
+     * @param task set to the task taken
+     * @return true if a task was taken, false if every other
+     * queue is empty
+     */
+    bool steal(size_t index, std::function<void()> &task);
+
+    /**
+     * Runs tasks on the calling thread until the pool is
+     * destroyed.
+     *
+     * @param index the index of the worker
+     */
+    void work(size_t index);
+
+public:
+    /**
+     * Creates a new pool and starts its workers.
+     *
+     * @param threads the number of workers
+     * @throws std::invalid_argument if the number of workers
+     * is zero
+     */
+    explicit thread_pool(size_t threads = std::max(std::thread::hardware_concurrency(), 1U));
+
+    /**
+     * Runs the tasks still queued, then stops and joins the
+     * workers.
+     */
+    ~thread_pool();
+
+    thread_pool(const thread_pool &) = delete;
+
+    thread_pool &operator=(const thread_pool &) = delete;
+
+    /**
+     * Obtains the number of workers.
+     *
+     * @return the number of worker threads
+     */
+    [[nodiscard]] size_t size() const;
+
+    /**
+     * Submits a task to be run by a worker. May be called
+     * from any thread, including from within a task.
+     *
+     * Tasks must not throw, and should not block waiting on
+     * other tasks, which may be queued behind them.
+     *
+     * @param task the task to run
+     */
+    void submit(std::function<void()> task);
+};
+
+#endif // TELEM_FILTER_THREAD_POOL_H
@@ -0,0 +1,63 @@
+#include "velocity_series.h"
+
+velocity_series_view::velocity_series_view(array_view<const double> times,
+                                           array_view<const double> x,
+                                           array_view<const double> y) :
+        times(times), x(x), y(y) {
+}
+
+velocity_series_view::velocity_series_view() = default;
+
+size_t velocity_series_view::size() const {
+    return times.size();
+}
+
+array_view<const double> velocity_series_view::get_times() const {
+    return times;
+}
+
+array_view<const double> velocity_series_view::get_x() const {
+    return x;
+}
+
+array_view<const double> velocity_series_view::get_y() const {
+    return y;
+}
+
+vector2d velocity_series_view::get(size_t idx) const {
+    return {x[idx], y[idx]};
+}
+
+velocity_series_view velocity_series_view::subview(size_t offset, size_t count) const {
+    return {times.subview(offset, count), x.subview(offset, count), y.subview(offset, count)};
+}
+
+void velocity_series::reserve(size_t capacity) {
+    times.reserve(capacity);
+    x.reserve(capacity);
+    y.reserve(capacity);
+}
+
+void velocity_series::clear() {
+    times.clear();
+    x.clear();
+    y.clear();
+}
+
+void velocity_series::push_back(double t, const vector2d &v) {
+    times.push_back(t);
+    x.push_back(v.get_x());
+    y.push_back(v.get_y());
+}
+
+size_t velocity_series::size() const {
+    return times.size();
+}
+
+vector2d velocity_series::get(size_t idx) const {
+    return {x[idx], y[idx]};
+}
+
+velocity_series_view velocity_series::view() const {
+    return {times, x, y};
+}
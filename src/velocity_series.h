@@ -0,0 +1,182 @@
+/**
+ * @file
+ */
+
+#ifndef TELEM_FILTER_VELOCITY_SERIES_H
+#define TELEM_FILTER_VELOCITY_SERIES_H
+
+#include <vector>
+
+#include "array_view.h"
+#include "vector2d.h"
+
+/**
+ * @brief A single velocity of a time series, as passed
+ * between streaming stages.
+ */
+struct velocity_sample {
+    /**
+     * The time offset of the velocity.
+     */
+    double time{0};
+    /**
+     * The velocity vector.
+     */
+    vector2d velocity{};
+};
+
+/**
+ * @brief A read-only, non-owning view of a velocity time
+ * series stored as parallel time, X and Y columns.
+ *
+ * Views are cheap to copy and remain valid for as long as
+ * the series they were obtained from is neither modified
+ * nor destroyed.
+ */
+class velocity_series_view {
+private:
+    /**
+     * The time offset of each velocity.
+     */
+    array_view<const double> times;
+    /**
+     * The X component of each velocity.
+     */
+    array_view<const double> x;
+    /**
+     * The Y component of each velocity.
+     */
+    array_view<const double> y;
+
+public:
+    /**
+     * Creates a view of the given columns, which must all
+     * have the same length.
+     *
+     * @param times the time column
+     * @param x the X component column
+     * @param y the Y component column
+     */
+    velocity_series_view(array_view<const double> times,
+                         array_view<const double> x,
+                         array_view<const double> y);
+
+    /**
+     * Creates an empty view.
+     */
+    velocity_series_view();
+
+    /**
+     * Obtains the number of velocities in the series.
+     *
+     * @return the length of each column
+     */
+    [[nodiscard]] size_t size() const;
+
+    /**
+     * Obtains the time offset of each velocity.
+     *
+     * @return the time column
+     */
+    [[nodiscard]] array_view<const double> get_times() const;
+
+    /**
+     * Obtains the X component of each velocity.
+     *
+     * @return the X component column
+     */
+    [[nodiscard]] array_view<const double> get_x() const;
+
+    /**
+     * Obtains the Y component of each velocity.
+     *
+     * @return the Y component column
+     */
+    [[nodiscard]] array_view<const double> get_y() const;
+
+    /**
+     * Obtains the velocity at the given index.
+     *
+     * @param idx the index, less than size()
+     * @return the velocity vector
+     */
+    [[nodiscard]] vector2d get(size_t idx) const;
+
+    /**
+     * Obtains a view of a range of this series.
+     *
+     * @param offset the index of the first velocity
+     * @param count the number of velocities, which is
+     * clamped to the end of the series
+     * @return the view of the range
+     */
+    [[nodiscard]] velocity_series_view subview(size_t offset, size_t count) const;
+};
+
+/**
+ * @brief A velocity time series stored as parallel,
+ * contiguous time, X and Y columns.
+ */
+class velocity_series {
+private:
+    /**
+     * The time offset of each velocity.
+     */
+    std::vector<double> times;
+    /**
+     * The X component of each velocity.
+     */
+    std::vector<double> x;
+    /**
+     * The Y component of each velocity.
+     */
+    std::vector<double> y;
+
+public:
+    /**
+     * Preallocates storage for the given number of
+     * velocities so that appending them does not
+     * reallocate.
+     *
+     * @param capacity the expected length of the series
+     */
+    void reserve(size_t capacity);
+
+    /**
+     * Removes all velocities from the series, keeping the
+     * allocated storage.
+     */
+    void clear();
+
+    /**
+     * Appends a velocity to the end of the series.
+     *
+     * @param t the time offset of the velocity
+     * @param v the velocity vector
+     */
+    void push_back(double t, const vector2d &v);
+
+    /**
+     * Obtains the number of velocities in the series.
+     *
+     * @return the length of each column
+     */
+    [[nodiscard]] size_t size() const;
+
+    /**
+     * Obtains the velocity at the given index.
+     *
+     * @param idx the index, less than size()
+     * @return the velocity vector
+     */
+    [[nodiscard]] vector2d get(size_t idx) const;
+
+    /**
+     * Obtains a read-only view of the series.
+     *
+     * @return the view of every velocity
+     */
+    [[nodiscard]] velocity_series_view view() const;
+};
+
+#endif // TELEM_FILTER_VELOCITY_SERIES_H
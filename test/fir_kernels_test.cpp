@@ -0,0 +1,429 @@
+/**
+ * @file
+ *
+ * Checks the SIMD FIR kernels, and the filters built on
+ * them, against the scalar reference. Exits with a non-zero
+ * status if any result is outside the tolerance.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "digital_filter.h"
+#include "fir_kernels.h"
+#include "fixed_fir.h"
+#include "pm_lpf_coeffs.h"
+#include "polyphase_filter.h"
+
+/**
+ * The largest difference from the scalar reference allowed,
+ * relative to the sum of the magnitudes of the products of
+ * each output.
+ */
+static const double KERNEL_TOLERANCE = 1e-9;
+
+/**
+ * The largest difference from the scalar reference allowed
+ * for FFT overlap-save, relative as for KERNEL_TOLERANCE.
+ */
+static const double FFT_TOLERANCE = 5e-13;
+
+/**
+ * The numbers of outputs computed per kernel call, which
+ * cover the tails left over by every vector width.
+ */
+static const size_t BLOCK_SIZES[] = {1, 2, 3, 7, 8, 15, 16, 17, 31, 32, 33, 63, 100, 257};
+
+/**
+ * The largest number of channels convolved together, which
+ * covers the channel left over by the pairs.
+ */
+static const size_t MAX_CHANNELS = 3;
+
+/**
+ * The number of checks which have failed.
+ */
+static int failures = 0;
+
+/**
+ * Generates random values uniformly distributed in the
+ * given range.
+ *
+ * @param rng the random number generator
+ * @param n the number of values
+ * @param scale the largest magnitude
+ * @return the values
+ */
+static std::vector<double> random_values(std::mt19937 &rng, size_t n, double scale) {
+    std::uniform_real_distribution<double> dist{-scale, scale};
+    std::vector<double> values(n);
+    for (double &value : values) {
+        value = dist(rng);
+    }
+
+    return values;
+}
+
+/**
+ * Mirrors the first half of the coefficients onto the
+ * second half.
+ *
+ * @param coeffs the coefficients, overwritten
+ * @param antisymmetric true to negate the mirror image
+ */
+static void make_symmetric(std::vector<double> &coeffs, bool antisymmetric) {
+    size_t taps = coeffs.size();
+    for (size_t k = 0; k < taps / 2; ++k) {
+        coeffs[taps - 1 - k] = antisymmetric ? -coeffs[k] : coeffs[k];
+    }
+    if (antisymmetric && taps % 2 != 0) {
+        coeffs[taps / 2] = 0;
+    }
+}
+
+/**
+ * Computes the error bound of each output of a convolution,
+ * the sum of the magnitudes of its products.
+ *
+ * @param coeffs the reversed coefficients
+ * @param samples the samples, of length n + taps - 1
+ * @param n the number of outputs
+ * @return the bound of each output
+ */
+static std::vector<double> error_scale(const std::vector<double> &coeffs, const double *samples, size_t n) {
+    std::vector<double> scale(n);
+    for (size_t j = 0; j < n; ++j) {
+        for (size_t k = 0; k < coeffs.size(); ++k) {
+            scale[j] += std::abs(coeffs[k] * samples[j + k]);
+        }
+    }
+
+    return scale;
+}
+
+/**
+ * Compares results to the reference, recording a failure if
+ * any differs by more than the tolerance.
+ *
+ * @param what the description of the check
+ * @param actual the results
+ * @param expected the reference results
+ * @param scale the error bound of each result
+ * @param tolerance the tolerance relative to the bound
+ */
+static void check(const char *what,
+                  const std::vector<double> &actual,
+                  const std::vector<double> &expected,
+                  const std::vector<double> &scale,
+                  double tolerance) {
+    double worst = 0;
+    for (size_t i = 0; i < expected.size(); ++i) {
+        worst = std::max(worst, std::abs(actual[i] - expected[i]) / std::max(scale[i], 1e-300));
+    }
+
+    if (!(worst <= tolerance)) {
+        std::printf("FAIL %s: relative error %g exceeds %g\n", what, worst, tolerance);
+        ++failures;
+    }
+}
+
+/**
+ * Checks the kernels of an instruction set against the
+ * scalar kernels for every tap count up to 39, and 100, and
+ * every block size.
+ *
+ * @param isa the instruction set
+ * @param rng the random number generator
+ */
+static void check_kernels(simd_isa isa, std::mt19937 &rng) {
+    char what[128];
+    std::vector<size_t> tap_counts(39);
+    for (size_t taps = 1; taps <= 39; ++taps) {
+        tap_counts[taps - 1] = taps;
+    }
+    tap_counts.push_back(100);
+
+    for (size_t taps : tap_counts) {
+        for (bool antisymmetric : {false, true}) {
+            std::vector<double> coeffs = random_values(rng, taps, 1);
+            make_symmetric(coeffs, antisymmetric);
+            std::vector<double> half_coeffs(coeffs.begin(), coeffs.begin() + (taps + 1) / 2);
+
+            for (size_t n : BLOCK_SIZES) {
+                std::vector<double> samples = random_values(rng, n + taps - 1, 1);
+                std::vector<double> scale = error_scale(coeffs, samples.data(), n);
+
+                // The plain scalar kernel is the reference for
+                // every other kernel
+                std::vector<double> expected(n);
+                fir_kernels::conv(simd_isa::scalar)(coeffs.data(), taps, samples.data(), expected.data(), n);
+
+                std::vector<double> actual(n);
+                fir_kernels::conv(isa)(coeffs.data(), taps, samples.data(), actual.data(), n);
+                std::snprintf(what, sizeof(what), "%s conv, %zu taps, %zu outputs", fir_kernels::name(isa), taps, n);
+                check(what, actual, expected, scale, KERNEL_TOLERANCE);
+
+                for (size_t j = 0; j < n; ++j) {
+                    actual[j] = fir_kernels::dot(isa)(coeffs.data(), samples.data() + j, taps);
+                }
+                std::snprintf(what, sizeof(what), "%s dot, %zu taps", fir_kernels::name(isa), taps);
+                check(what, actual, expected, scale, KERNEL_TOLERANCE);
+
+                // Every channel holds a copy of the samples
+                // scaled by a different power of two, which
+                // scales the reference exactly
+                std::vector<std::vector<double>> channel_samples(MAX_CHANNELS);
+                std::vector<std::vector<double>> channel_actual(MAX_CHANNELS, std::vector<double>(n));
+                std::vector<const double *> samples_ptrs(MAX_CHANNELS);
+                std::vector<double *> out_ptrs(MAX_CHANNELS);
+                for (size_t c = 0; c < MAX_CHANNELS; ++c) {
+                    channel_samples[c] = samples;
+                    for (double &sample : channel_samples[c]) {
+                        sample = std::ldexp(sample, -static_cast<int>(c));
+                    }
+                    samples_ptrs[c] = channel_samples[c].data();
+                    out_ptrs[c] = channel_actual[c].data();
+                }
+                auto check_channels = [&](const char *kernel, size_t channels) {
+                    for (size_t c = 0; c < channels; ++c) {
+                        std::vector<double> channel_expected = expected;
+                        std::vector<double> channel_scale = scale;
+                        for (size_t j = 0; j < n; ++j) {
+                            channel_expected[j] = std::ldexp(expected[j], -static_cast<int>(c));
+                            channel_scale[j] = std::ldexp(scale[j], -static_cast<int>(c));
+                        }
+                        std::snprintf(what, sizeof(what), "%s %s, %zu taps, channel %zu of %zu, %zu outputs",
+                                      fir_kernels::name(isa), kernel, taps, c, channels, n);
+                        check(what, channel_actual[c], channel_expected, channel_scale, KERNEL_TOLERANCE);
+                    }
+                };
+
+                for (size_t channels = 1; channels <= MAX_CHANNELS; ++channels) {
+                    fir_kernels::conv_channels(isa)(coeffs.data(), taps, samples_ptrs.data(), out_ptrs.data(),
+                                                    channels, n);
+                    check_channels("conv_channels", channels);
+                }
+
+                // The symmetric kernels only use the first half
+                // of the coefficients
+                if (taps < 2) {
+                    continue;
+                }
+
+                fir_kernels::sym_conv(isa, antisymmetric)(half_coeffs.data(), taps,
+                                                          samples.data(), actual.data(), n);
+                std::snprintf(what, sizeof(what), "%s sym_conv, %zu %s taps, %zu outputs",
+                              fir_kernels::name(isa), taps, antisymmetric ? "antisymmetric" : "symmetric", n);
+                check(what, actual, expected, scale, KERNEL_TOLERANCE);
+
+                for (size_t j = 0; j < n; ++j) {
+                    actual[j] = fir_kernels::sym_dot(isa, antisymmetric)(half_coeffs.data(),
+                                                                         samples.data() + j, taps);
+                }
+                std::snprintf(what, sizeof(what), "%s sym_dot, %zu %s taps",
+                              fir_kernels::name(isa), taps, antisymmetric ? "antisymmetric" : "symmetric");
+                check(what, actual, expected, scale, KERNEL_TOLERANCE);
+
+                for (size_t channels = 1; channels <= MAX_CHANNELS; ++channels) {
+                    fir_kernels::sym_conv_channels(isa, antisymmetric)(half_coeffs.data(), taps,
+                                                                       samples_ptrs.data(), out_ptrs.data(),
+                                                                       channels, n);
+                    check_channels(antisymmetric ? "antisymmetric sym_conv_channels" : "sym_conv_channels",
+                                   channels);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Convolves a signal from rest with the scalar reference
+ * kernel.
+ *
+ * @param coeffs the numerator coefficients
+ * @param signal the signal to filter
+ * @param expected set to the reference outputs
+ * @param scale set to the error bound of each output
+ */
+static void reference(const std::vector<double> &coeffs,
+                      const std::vector<double> &signal,
+                      std::vector<double> &expected,
+                      std::vector<double> &scale) {
+    size_t taps = coeffs.size();
+    std::vector<double> padded(taps - 1 + signal.size(), 0);
+    std::copy(signal.begin(), signal.end(), padded.begin() + taps - 1);
+    std::vector<double> coeffs_rev(coeffs.rbegin(), coeffs.rend());
+    expected.resize(signal.size());
+    fir_kernels::conv(simd_isa::scalar)(coeffs_rev.data(), taps, padded.data(), expected.data(), signal.size());
+    scale = error_scale(coeffs_rev, padded.data(), signal.size());
+}
+
+/**
+ * Checks a filter streamed in irregular blocks with an
+ * instruction set against the scalar reference convolution.
+ *
+ * @param isa the instruction set
+ * @param coeffs the numerator coefficients
+ * @param signal the signal to filter
+ * @param tolerance the tolerance relative to the error
+ * bound of each output
+ */
+static void check_stream(simd_isa isa,
+                         const std::vector<double> &coeffs,
+                         const std::vector<double> &signal,
+                         double tolerance) {
+    // Long filters use overlap-save even with the scalar
+    // instruction set, so the reference is convolved
+    // directly from rest
+    std::vector<double> expected, scale;
+    reference(coeffs, signal, expected, scale);
+
+    // The symmetry is detected, so the symmetric kernels are
+    // used if the coefficients allow
+    digital_filter filter{coeffs};
+    filter.set_isa(isa);
+
+    std::vector<double> actual(signal.size());
+    size_t pos = 0;
+    for (size_t i = 0; pos < signal.size(); ++i) {
+        size_t len = std::min(BLOCK_SIZES[i % std::size(BLOCK_SIZES)] * (i % 3 + 1), signal.size() - pos);
+        filter.process_block({signal.data() + pos, len}, {actual.data() + pos, len});
+        pos += len;
+    }
+
+    char what[128];
+    std::snprintf(what, sizeof(what), "%s digital_filter stream, %zu taps", fir_kernels::name(isa), coeffs.size());
+    check(what, actual, expected, scale, tolerance);
+}
+
+/**
+ * Checks a filter transforming several channels together
+ * with an instruction set against the scalar reference
+ * convolution of each.
+ *
+ * @param isa the instruction set
+ * @param coeffs the numerator coefficients
+ * @param signal the signal to filter
+ */
+static void check_channels(simd_isa isa,
+                           const std::vector<double> &coeffs,
+                           const std::vector<double> &signal) {
+    std::vector<double> expected, scale;
+    reference(coeffs, signal, expected, scale);
+
+    digital_filter filter{coeffs};
+    filter.set_isa(isa);
+
+    // The channels are the signal scaled by powers of two,
+    // which scale the reference exactly
+    std::vector<std::vector<double>> channels(MAX_CHANNELS, signal);
+    for (size_t c = 0; c < MAX_CHANNELS; ++c) {
+        for (double &sample : channels[c]) {
+            sample = std::ldexp(sample, -static_cast<int>(c));
+        }
+    }
+    std::vector<std::vector<double>> results = filter.transform_channels({channels.begin(), channels.end()});
+
+    char what[128];
+    for (size_t c = 0; c < MAX_CHANNELS; ++c) {
+        std::vector<double> channel_expected(signal.size());
+        std::vector<double> channel_scale(signal.size());
+        for (size_t i = 0; i < signal.size(); ++i) {
+            channel_expected[i] = std::ldexp(expected[i], -static_cast<int>(c));
+            channel_scale[i] = std::ldexp(scale[i], -static_cast<int>(c));
+        }
+        std::snprintf(what, sizeof(what), "%s digital_filter channel %zu, %zu taps",
+                      fir_kernels::name(isa), c, coeffs.size());
+        check(what, results[c], channel_expected, channel_scale, KERNEL_TOLERANCE);
+    }
+}
+
+/**
+ * Checks the transformation of several channels by the
+ * filters specialized at compile time and by the decimator
+ * against their transformation of each channel alone.
+ *
+ * @param signal the signal to filter
+ */
+static void check_channel_filters(const std::vector<double> &signal) {
+    std::vector<double> negated(signal.size());
+    std::transform(signal.begin(), signal.end(), negated.begin(), [](double x) { return -x; });
+    std::vector<array_view<const double>> channels{signal, negated, signal};
+
+    // The reference of each channel is computed as one with
+    // the same kernels, so the error bound is scaled by the
+    // largest output
+    auto check_against = [](const char *what,
+                            const std::vector<std::vector<double>> &actual,
+                            const std::vector<std::vector<double>> &expected) {
+        for (size_t c = 0; c < expected.size(); ++c) {
+            double largest = 0;
+            for (double y : expected[c]) {
+                largest = std::max(largest, std::abs(y));
+            }
+            check(what, actual[c], expected[c], std::vector<double>(expected[c].size(), largest),
+                  KERNEL_TOLERANCE);
+        }
+    };
+
+    fixed_fir<PM_LPF_COEFFS> lpf;
+    std::vector<std::vector<double>> expected;
+    for (array_view<const double> channel : channels) {
+        expected.push_back(lpf.transform(channel));
+    }
+    check_against("fixed_fir channels", lpf.transform_channels(channels), expected);
+
+    for (size_t factor : {2, 3, 5}) {
+        polyphase_decimator decimator{polyphase_decimator::design_lowpass(factor, 4), factor};
+        expected.clear();
+        for (array_view<const double> channel : channels) {
+            expected.push_back(decimator.transform(channel));
+        }
+        check_against("polyphase_decimator channels", decimator.transform_channels(channels), expected);
+    }
+}
+
+int main() {
+    std::mt19937 rng{20191};
+
+    for (simd_isa isa : {simd_isa::scalar, simd_isa::sse2, simd_isa::avx2, simd_isa::avx512}) {
+        if (!fir_kernels::supported(isa)) {
+            std::printf("%s is not supported, skipped\n", fir_kernels::name(isa));
+            continue;
+        }
+
+        check_kernels(isa, rng);
+
+        // The filters stream every tap count through the
+        // block kernels, and those from the crossover of
+        // each instruction set through FFT overlap-save
+        std::vector<double> signal = random_values(rng, 20000, 3000);
+        for (size_t taps : {1, 2, 5, 16, 31, 32, 39, 100, 159, 160}) {
+            for (bool symmetric : {false, true}) {
+                std::vector<double> coeffs = random_values(rng, taps, 1);
+                if (symmetric) {
+                    make_symmetric(coeffs, false);
+                }
+                check_stream(isa, coeffs, signal, KERNEL_TOLERANCE);
+                check_channels(isa, coeffs, signal);
+            }
+        }
+        for (size_t taps : {384, 1000, 3000}) {
+            check_stream(isa, random_values(rng, taps, 1), signal, FFT_TOLERANCE);
+        }
+
+        std::printf("%s checked\n", fir_kernels::name(isa));
+    }
+
+    check_channel_filters(random_values(rng, 20001, 3000));
+
+    if (failures != 0) {
+        std::printf("%d checks failed\n", failures);
+        return 1;
+    }
+
+    return 0;
+}